@@ -0,0 +1,372 @@
+/*
+    basic_pool: policy-based thread pool
+    threadpool 与 LockFreePool 均为 basic_pool 的别名, 见 pool_policies.hpp
+
+    - QueuePolicy: 任务队列 (list_queue / circular_queue<N> / inline_queue<Bytes>)
+    - WaitPolicy:  空闲线程等待方式 (spin_wait / yield_wait / cv_wait)
+    - TaskPolicy:  任务封装及 append 返回值 (future_task / detached_task)
+    - IoPolicy:    线程内的异步 I/O (no_io / uring_io, 见 io_uring.hpp)
+    - ContextPolicy: 线程本地上下文 (no_context / arena_context<N>, 见 worker_context.hpp)
+
+    语义:
+    - thread_number <= 0 时构造函数抛出 std::invalid_argument
+    - shutdown 后不再接受新任务, 已入队的任务执行完毕后线程退出
+    - shutdown 可重复调用, 之后可再次 init
+    - init(true) 等待所有线程完成启动(构造上下文、执行 on_start、预热栈)后返回, 避免首批任务的延迟尖峰
+
+    key 亲和:
+    - append_to(key, f, args...) 将相同 key 的任务交给同一个线程, 使分片数据留在该线程的 cache 中
+    - 每个线程拥有一个本地队列, 线程优先执行本地队列中的任务, 再从共享队列中取任务
+    - 本地队列中的任务数达到 affinity_limit 时(线程过载), 任务溢出到共享队列由任意线程执行
+    - 本地队列在第一次 append_to 到该线程时才分配, 不使用 append_to 的线程池没有额外的内存占用
+    - 每个线程在自己的 WaitPolicy 上等待, append_to 只唤醒所属线程; 共享队列的任务唤醒一个正在等待的线程
+
+    线程本地上下文:
+    - 每个线程在启动时构造一个 ContextPolicy::context, 之后调用 on_start 回调, 退出前调用 on_stop 回调
+    - append_with_context(f, args...) 以 f(context&, args...) 的形式调用任务, 直接传入执行线程的上下文
+    - 每个任务执行后调用 context.after_task(), 如重置 arena
+
+    阻塞任务:
+    - append_blocking(f, args...) 将任务交给内部的弹性线程池 blocking_pool, 见 blocking_pool.hpp
+    - 返回值与 append 相同, init / shutdown 同时作用于两个线程池
+*/
+#pragma once
+
+#include<vector>
+#include<memory>
+#include<thread>
+#include<atomic>
+#include<stdexcept>
+#include<functional>
+
+#include"pool_policies.hpp"
+#include"blocking_pool.hpp"
+
+template<typename QueuePolicy, typename WaitPolicy, typename TaskPolicy, typename IoPolicy = no_io, typename ContextPolicy = no_context>
+class basic_pool
+{
+public:
+    using context_type = typename ContextPolicy::context;
+    using task_type = typename TaskPolicy::template task_type<context_type>;
+    using queue_type = typename QueuePolicy::template queue<task_type>;
+    using hook_type = std::function<void(int, context_type &)>;     // (线程编号, 上下文)
+
+    basic_pool(int thread_number = 8, size_t affinity_limit = 64);
+    ~basic_pool();
+
+    // add a request to pool asynchronously
+    template <typename F, typename... Args>                 // c++11 variadic template
+    decltype(auto) append(F &&, Args &&...);                // Universal reference for perfect forwarding
+
+    // add a request to the worker that owns key
+    template <typename Key, typename F, typename... Args>
+    decltype(auto) append_to(const Key &, F &&, Args &&...);
+
+    // add a request called as f(context&, args...) with the context of the executing worker
+    template <typename F, typename... Args>
+    decltype(auto) append_with_context(F &&, Args &&...);
+
+    // add a long or blocking request to the companion blocking_pool
+    template <typename F, typename... Args>
+    decltype(auto) append_blocking(F &&, Args &&...);
+
+    // blocking_pool 的线程数上限与空闲线程的回收时间
+    void set_blocking_limit(int max_threads, std::chrono::milliseconds idle_timeout)
+    {
+        blocking_.set_limit(max_threads, idle_timeout);
+    }
+
+    // worker lifecycle hooks, set before init
+    void on_start(hook_type hook) { on_start_ = std::move(hook); }
+    void on_stop(hook_type hook) { on_stop_ = std::move(hook); }
+
+    void init(bool warm_start = false);     // initialize thread pool
+    void shutdown();   // shutdown thread pool
+
+#pragma region delete copy and move
+    basic_pool(const basic_pool &) = delete;
+    basic_pool(const basic_pool &&) = delete;
+    basic_pool &operator=(const basic_pool &) = delete;
+    basic_pool &operator=(const basic_pool &&) = delete;
+#pragma endregion
+
+private:
+    // 每个线程的本地队列, 多个生产者, 只有所属线程消费
+    struct alignas(64) worker_slot
+    {
+        ~worker_slot() { delete queue.load(std::memory_order_relaxed); }
+
+        std::atomic<queue_type *> queue{nullptr};   // 第一次 append_to 时分配
+        std::atomic<size_t> depth{0};
+        WaitPolicy wait;                            // 所属线程空闲时在此等待
+    };
+
+    void threadFunc(int index); // loop function for each thread
+    static queue_type &localQueue(worker_slot &slot);      // 返回 slot 的本地队列, 尚未分配时分配
+    __attribute__((noinline)) static void warmStack();    // 预先触碰线程栈, 避免任务执行时的缺页
+    void notifyIdle();                  // 唤醒一个正在等待的线程, 用于共享队列
+    template<typename Task>
+    void push(Task &&task);             // 任务放入共享队列
+    template<typename Task>
+    void requeue(Task &&task, context_type &context);     // I/O 完成后的回调入队, 不受 shutdown 影响
+
+    // 取出一个任务并执行, 队列为空时返回 false; 队列提供 consume 时在队列中原地执行
+    template<typename Queue>
+    static auto runTask(Queue &queue, context_type &context, int) -> decltype(queue.consume(context));
+    template<typename Queue>
+    static bool runTask(Queue &queue, context_type &context, long);
+private:
+    std::vector<std::shared_ptr<std::thread>> threads_;
+    std::atomic<bool> stop_;
+    std::atomic<int> started_;          // 已完成启动的线程数
+    int thread_number_;
+    size_t affinity_limit_;
+    queue_type queue_;
+    std::unique_ptr<worker_slot[]> slots_;
+    hook_type on_start_;
+    hook_type on_stop_;
+    blocking_pool<TaskPolicy, ContextPolicy> blocking_;
+};
+
+template<typename QueuePolicy, typename WaitPolicy, typename TaskPolicy, typename IoPolicy, typename ContextPolicy>
+basic_pool<QueuePolicy, WaitPolicy, TaskPolicy, IoPolicy, ContextPolicy>::basic_pool(int thread_number, size_t affinity_limit)
+    : stop_(false), started_(0), thread_number_(thread_number), affinity_limit_(affinity_limit), queue_()
+{
+    if (thread_number <= 0)
+    {
+        throw std::invalid_argument("basic_pool: thread_number must be positive");
+    }
+    slots_.reset(new worker_slot[thread_number]);
+}
+
+template<typename QueuePolicy, typename WaitPolicy, typename TaskPolicy, typename IoPolicy, typename ContextPolicy>
+basic_pool<QueuePolicy, WaitPolicy, TaskPolicy, IoPolicy, ContextPolicy>::~basic_pool()
+{
+    shutdown();
+}
+
+template<typename QueuePolicy, typename WaitPolicy, typename TaskPolicy, typename IoPolicy, typename ContextPolicy>
+void basic_pool<QueuePolicy, WaitPolicy, TaskPolicy, IoPolicy, ContextPolicy>::init(bool warm_start)
+{
+    if (!threads_.empty()) return;
+    stop_.store(false, std::memory_order_release);
+    started_.store(0, std::memory_order_relaxed);
+    blocking_.init();
+    for (int i = 0; i < thread_number_; ++i)
+    {
+        threads_.emplace_back(std::make_shared<std::thread>(&basic_pool::threadFunc, this, i));
+    }
+    if (warm_start)
+    {
+        while (started_.load(std::memory_order_acquire) < thread_number_)
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+template<typename QueuePolicy, typename WaitPolicy, typename TaskPolicy, typename IoPolicy, typename ContextPolicy>
+void basic_pool<QueuePolicy, WaitPolicy, TaskPolicy, IoPolicy, ContextPolicy>::warmStack()
+{
+    constexpr size_t warm_stack_size = 64 * 1024;
+    constexpr size_t page_size = 4096;
+    unsigned char stack[warm_stack_size];
+    volatile unsigned char *p = stack;
+    for (size_t i = 0; i < warm_stack_size; i += page_size)
+    {
+        p[i] = 0;
+    }
+}
+
+template<typename QueuePolicy, typename WaitPolicy, typename TaskPolicy, typename IoPolicy, typename ContextPolicy>
+void basic_pool<QueuePolicy, WaitPolicy, TaskPolicy, IoPolicy, ContextPolicy>::shutdown()
+{
+    stop_.store(true, std::memory_order_release);
+    for (int i = 0; i < thread_number_; ++i)
+    {
+        slots_[i].wait.notify_all();
+    }
+    for (auto &thread : threads_)
+    {
+        if (thread->joinable())
+        {
+            thread->join();
+        }
+    }
+    threads_.clear();
+    blocking_.shutdown();
+}
+
+template<typename QueuePolicy, typename WaitPolicy, typename TaskPolicy, typename IoPolicy, typename ContextPolicy>
+template <typename F, typename... Args>
+decltype(auto) basic_pool<QueuePolicy, WaitPolicy, TaskPolicy, IoPolicy, ContextPolicy>::append(F &&f, Args &&... args)
+{
+    return TaskPolicy::template submit<context_type>([this](auto &&task)
+    {
+        if (stop_.load(std::memory_order_acquire))
+            return;                                         // 丢弃任务
+        push(std::forward<decltype(task)>(task));
+    }, [func = std::bind(std::forward<F>(f), std::forward<Args>(args)...)](context_type &) mutable { return func(); });
+}
+
+template<typename QueuePolicy, typename WaitPolicy, typename TaskPolicy, typename IoPolicy, typename ContextPolicy>
+template <typename F, typename... Args>
+decltype(auto) basic_pool<QueuePolicy, WaitPolicy, TaskPolicy, IoPolicy, ContextPolicy>::append_with_context(F &&f, Args &&... args)
+{
+    return TaskPolicy::template submit<context_type>([this](auto &&task)
+    {
+        if (stop_.load(std::memory_order_acquire))
+            return;                                         // 丢弃任务
+        push(std::forward<decltype(task)>(task));
+    }, std::bind(std::forward<F>(f), std::placeholders::_1, std::forward<Args>(args)...));
+}
+
+template<typename QueuePolicy, typename WaitPolicy, typename TaskPolicy, typename IoPolicy, typename ContextPolicy>
+template <typename F, typename... Args>
+decltype(auto) basic_pool<QueuePolicy, WaitPolicy, TaskPolicy, IoPolicy, ContextPolicy>::append_blocking(F &&f, Args &&... args)
+{
+    return blocking_.append(std::forward<F>(f), std::forward<Args>(args)...);
+}
+
+template<typename QueuePolicy, typename WaitPolicy, typename TaskPolicy, typename IoPolicy, typename ContextPolicy>
+template <typename Key, typename F, typename... Args>
+decltype(auto) basic_pool<QueuePolicy, WaitPolicy, TaskPolicy, IoPolicy, ContextPolicy>::append_to(const Key &key, F &&f, Args &&... args)
+{
+    worker_slot &slot = slots_[std::hash<Key>()(key) % thread_number_];
+    return TaskPolicy::template submit<context_type>([this, &slot](auto &&task)
+    {
+        if (stop_.load(std::memory_order_acquire))
+            return;                                         // 丢弃任务
+        // 本地队列满时 push 返回 false 且不移动 task
+        if (slot.depth.fetch_add(1, std::memory_order_relaxed) < affinity_limit_ &&
+            localQueue(slot).push(std::forward<decltype(task)>(task)))
+        {
+            slot.wait.notify_one();                         // 只有所属线程能执行该任务, 只唤醒它
+            return;
+        }
+        slot.depth.fetch_sub(1, std::memory_order_relaxed);
+        push(std::forward<decltype(task)>(task));           // 所属线程过载, 溢出到共享队列
+    }, [func = std::bind(std::forward<F>(f), std::forward<Args>(args)...)](context_type &) mutable { return func(); });
+}
+
+template<typename QueuePolicy, typename WaitPolicy, typename TaskPolicy, typename IoPolicy, typename ContextPolicy>
+typename basic_pool<QueuePolicy, WaitPolicy, TaskPolicy, IoPolicy, ContextPolicy>::queue_type &
+basic_pool<QueuePolicy, WaitPolicy, TaskPolicy, IoPolicy, ContextPolicy>::localQueue(worker_slot &slot)
+{
+    queue_type *queue = slot.queue.load(std::memory_order_acquire);
+    if (queue == nullptr)
+    {
+        // 多个生产者同时分配时只保留一个
+        queue_type *created = new queue_type();
+        if (slot.queue.compare_exchange_strong(queue, created, std::memory_order_acq_rel, std::memory_order_acquire))
+            queue = created;
+        else
+            delete created;
+    }
+    return *queue;
+}
+
+template<typename QueuePolicy, typename WaitPolicy, typename TaskPolicy, typename IoPolicy, typename ContextPolicy>
+void basic_pool<QueuePolicy, WaitPolicy, TaskPolicy, IoPolicy, ContextPolicy>::notifyIdle()
+{
+    // notify_one 返回 false 表示该线程没有在等待(正在执行任务, 或等待前会看到新任务)或已被其他生产者唤醒, 继续尝试下一个
+    for (int i = 0; i < thread_number_; ++i)
+    {
+        if (slots_[i].wait.notify_one())
+            return;
+    }
+}
+
+template<typename QueuePolicy, typename WaitPolicy, typename TaskPolicy, typename IoPolicy, typename ContextPolicy>
+template<typename Task>
+void basic_pool<QueuePolicy, WaitPolicy, TaskPolicy, IoPolicy, ContextPolicy>::push(Task &&task)
+{
+    while (!queue_.push(std::forward<Task>(task)))          // 队列满时等待消费者, 失败的 push 不移动 task
+    {
+        std::this_thread::yield();
+    }
+    notifyIdle();
+}
+
+template<typename QueuePolicy, typename WaitPolicy, typename TaskPolicy, typename IoPolicy, typename ContextPolicy>
+void basic_pool<QueuePolicy, WaitPolicy, TaskPolicy, IoPolicy, ContextPolicy>::threadFunc(int index)
+{
+    worker_slot &slot = slots_[index];
+    typename IoPolicy::worker io;
+    context_type context;
+    if (on_start_)
+        on_start_(index, context);
+    warmStack();
+    started_.fetch_add(1, std::memory_order_release);
+    auto has_local = [&slot]()
+    {
+        queue_type *local = slot.queue.load(std::memory_order_acquire);
+        return local != nullptr && !local->empty();
+    };
+    while (true)
+    {
+        io.reap([this, &context](auto &&done)
+        {
+            // 回调与 append 的任务一样经 TaskPolicy 封装, future_task 中回调抛出的异常不会逃出线程函数
+            TaskPolicy::template submit<context_type>([this, &context](auto &&task)
+            {
+                requeue(std::forward<decltype(task)>(task), context);
+            }, [done = std::forward<decltype(done)>(done)](context_type &) mutable { done(); });
+        });
+        queue_type *local = slot.queue.load(std::memory_order_acquire);
+        if (local != nullptr && runTask(*local, context, 0))    // 优先执行本地队列中的任务
+        {
+            slot.depth.fetch_sub(1, std::memory_order_relaxed);
+            context.after_task();
+            continue;
+        }
+        if (runTask(queue_, context, 0))
+        {
+            context.after_task();
+            continue;
+        }
+        if (io.pending())                                   // 有未完成的 I/O, 不能休眠
+        {
+            io.wait_completion();
+            continue;
+        }
+        if (stop_.load(std::memory_order_acquire))          // 队列已空且已关闭
+            break;
+        slot.wait.wait([this, &has_local]()
+                   { return stop_.load(std::memory_order_acquire) || !queue_.empty() || has_local(); });
+    }
+    if (on_stop_)
+        on_stop_(index, context);
+}
+
+template<typename QueuePolicy, typename WaitPolicy, typename TaskPolicy, typename IoPolicy, typename ContextPolicy>
+template<typename Task>
+void basic_pool<QueuePolicy, WaitPolicy, TaskPolicy, IoPolicy, ContextPolicy>::requeue(Task &&task, context_type &context)
+{
+    if (!queue_.push(std::forward<Task>(task)))             // 队列已满时直接执行, 避免所有线程互相等待
+    {
+        task(context);
+        context.after_task();
+        return;
+    }
+    notifyIdle();
+}
+
+template<typename QueuePolicy, typename WaitPolicy, typename TaskPolicy, typename IoPolicy, typename ContextPolicy>
+template<typename Queue>
+auto basic_pool<QueuePolicy, WaitPolicy, TaskPolicy, IoPolicy, ContextPolicy>::runTask(Queue &queue, context_type &context, int)
+    -> decltype(queue.consume(context))
+{
+    return queue.consume(context);
+}
+
+template<typename QueuePolicy, typename WaitPolicy, typename TaskPolicy, typename IoPolicy, typename ContextPolicy>
+template<typename Queue>
+bool basic_pool<QueuePolicy, WaitPolicy, TaskPolicy, IoPolicy, ContextPolicy>::runTask(Queue &queue, context_type &context, long)
+{
+    task_type task;
+    if (!queue.pop(task))
+        return false;
+    task(context);
+    return true;
+}
@@ -0,0 +1,126 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <random>
+#include <cstring>
+#include <cassert>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include "basic_pool.hpp"
+
+constexpr int thread_number = 4;            // 线程池中线程数量
+constexpr int shard_number = 64;            // 分片数量
+constexpr size_t shard_size = 32 * 1024;    // 每个分片的元素数量 (256 KB)
+constexpr int task_number = 20000;          // 任务数量
+
+// 基于 perf_event_open 的计数器, inherit 使得之后创建的线程也被计入
+class perf_counter
+{
+public:
+    perf_counter(uint32_t type, uint64_t config)
+    {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.type = type;
+        attr.size = sizeof(attr);
+        attr.config = config;
+        attr.disabled = 1;
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd_ = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+    ~perf_counter() { if (fd_ >= 0) close(fd_); }
+
+    void start() { if (fd_ >= 0) { ioctl(fd_, PERF_EVENT_IOC_RESET, 0); ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0); } }
+    void stop() { if (fd_ >= 0) ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0); }
+
+    // 计数器不可用时返回 -1
+    long long value() const
+    {
+        uint64_t count = 0;
+        if (fd_ < 0 || read(fd_, &count, sizeof(count)) != sizeof(count))
+            return -1;
+        return static_cast<long long>(count);
+    }
+
+private:
+    int fd_;
+};
+
+std::ostream& operator<<(std::ostream& os, const perf_counter& counter)
+{
+    long long v = counter.value();
+    return v < 0 ? os << "n/a" : os << v;
+}
+
+// 每个任务遍历一个分片并累加
+template<bool Affinity>
+void bench(const char* name, const std::vector<std::vector<uint64_t>>& shards, const std::vector<int>& keys)
+{
+    std::atomic<uint64_t> total{0};
+    perf_counter cache_misses(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    perf_counter l1d_misses(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D
+                            | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+    cache_misses.start();
+    l1d_misses.start();
+
+    auto start = std::chrono::steady_clock::now();
+    {
+        basic_pool<list_queue, cv_wait, detached_task> pool(thread_number);
+        pool.init();
+        for (int key : keys) {
+            auto task = [&shards, &total](int key) {
+                uint64_t sum = 0;
+                for (auto v : shards[key]) {
+                    sum += v;
+                }
+                total.fetch_add(sum, std::memory_order_relaxed);
+            };
+            if (Affinity)
+                pool.append_to(key, task, key);
+            else
+                pool.append(task, key);
+        }
+        pool.shutdown();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    cache_misses.stop();
+    l1d_misses.stop();
+    assert(total.load() == static_cast<uint64_t>(keys.size()) * shard_size);
+    std::cout << name << "\t" << std::chrono::duration<double, std::milli>(end - start).count() << " ms"
+              << "\tcache-misses: " << cache_misses << "\tL1d-read-misses: " << l1d_misses << std::endl;
+}
+
+int main() {
+    std::vector<std::vector<uint64_t>> shards(shard_number, std::vector<uint64_t>(shard_size, 1));
+    std::vector<int> keys(task_number);
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> dist(0, shard_number - 1);
+    for (auto& k : keys) {
+        k = dist(rng);
+    }
+
+    // 校验 append_to 将相同 key 交给同一个线程
+    {
+        basic_pool<list_queue, cv_wait, future_task> pool(thread_number);
+        pool.init();
+        std::vector<std::future<std::thread::id>> ids;
+        for (int i = 0; i < 16; ++i) {
+            ids.emplace_back(pool.append_to(7, []() { return std::this_thread::get_id(); }));
+        }
+        auto owner = ids.front().get();
+        for (size_t i = 1; i < ids.size(); ++i) {
+            assert(ids[i].get() == owner);
+        }
+    }
+
+    std::cout << "shards: " << shard_number << " x " << shard_size * sizeof(uint64_t) / 1024 << " KB, tasks: "
+              << task_number << ", threads: " << thread_number << std::endl;
+    bench<false>("append   ", shards, keys);
+    bench<true>("append_to", shards, keys);
+    return 0;
+}
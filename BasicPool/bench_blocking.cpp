@@ -0,0 +1,70 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include "basic_pool.hpp"
+
+constexpr int thread_number = 4;        // CPU 线程池中线程数量
+constexpr int cpu_task_number = 2000;   // 短 CPU 任务数量
+constexpr int blocking_task_number = 16;// 阻塞任务数量
+
+using clock_type = std::chrono::steady_clock;
+
+// 短 CPU 任务
+long long spin(int n)
+{
+    long long sum = 0;
+    for (int i = 0; i < n; ++i) {
+        sum += static_cast<long long>(i) * i;
+    }
+    return sum;
+}
+
+// 统计短 CPU 任务从提交到执行完毕的延迟; Blocking: 0 无阻塞任务, 1 阻塞任务使用 append, 2 使用 append_blocking
+template<int Blocking>
+void bench(const char* name)
+{
+    basic_pool<list_queue, cv_wait, future_task> pool(thread_number);
+    pool.init();
+
+    std::vector<std::future<void>> blocking;
+    for (int i = 0; i < blocking_task_number; ++i) {
+        auto task = []() { std::this_thread::sleep_for(std::chrono::milliseconds(100)); };
+        if (Blocking == 1)
+            blocking.emplace_back(pool.append(task));
+        else if (Blocking == 2)
+            blocking.emplace_back(pool.append_blocking(task));
+    }
+
+    std::vector<std::future<double>> latencies;
+    for (int i = 0; i < cpu_task_number; ++i) {
+        auto submit = clock_type::now();
+        latencies.emplace_back(pool.append([submit]() {
+            spin(1000);
+            return std::chrono::duration<double, std::micro>(clock_type::now() - submit).count();
+        }));
+    }
+    std::vector<double> result;
+    for (auto& l : latencies) {
+        result.push_back(l.get());
+    }
+    for (auto& b : blocking) {
+        b.get();
+    }
+    pool.shutdown();
+
+    std::sort(result.begin(), result.end());
+    std::cout << name << "\tp50: " << result[result.size() / 2] << " us"
+              << "\tp99: " << result[result.size() * 99 / 100] << " us"
+              << "\tmax: " << result.back() << " us" << std::endl;
+}
+
+int main() {
+    std::cout << "cpu tasks: " << cpu_task_number << ", blocking tasks: " << blocking_task_number
+              << " x 100 ms, threads: " << thread_number << std::endl;
+    bench<0>("cpu only               ");
+    bench<1>("blocking in append     ");
+    bench<2>("blocking in append_blocking");
+    return 0;
+}
@@ -0,0 +1,144 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <numeric>
+#include <cassert>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#include "basic_pool.hpp"
+#include "io_uring.hpp"
+
+constexpr int thread_number = 4;        // 线程池中线程数量
+constexpr int file_number = 512;        // 文件数量
+constexpr size_t file_size = 64 * 1024; // 每个文件大小
+
+// 文件内容为 (文件编号 + 偏移) 的低 8 位, 返回所有字节之和
+long long checksum(int id, const unsigned char* buf, size_t len)
+{
+    long long sum = 0;
+    for (size_t i = 0; i < len; ++i) {
+        assert(buf[i] == static_cast<unsigned char>(id + i));
+        sum += buf[i];
+    }
+    return sum;
+}
+
+// 通过线程池用 async_write + async_fsync 生成测试文件
+void createFiles(const std::string& dir)
+{
+    std::atomic<int> remaining{file_number};
+    std::promise<void> done;
+    basic_pool<list_queue, cv_wait, detached_task, uring_io> pool(thread_number);
+    pool.init();
+    for (int id = 0; id < file_number; ++id) {
+        pool.append([&, id]() {
+            std::string path = dir + "/" + std::to_string(id);
+            int fd = open(path.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 0644);
+            assert(fd >= 0);
+            auto buf = std::make_shared<std::vector<unsigned char>>(file_size);
+            for (size_t i = 0; i < file_size; ++i) {
+                (*buf)[i] = static_cast<unsigned char>(id + i);
+            }
+            async_write(fd, buf->data(), file_size, 0, [&, fd, buf](int res) {
+                assert(res == static_cast<int>(file_size));
+                async_fsync(fd, [&, fd](int res) {
+                    assert(res == 0);
+                    close(fd);
+                    if (remaining.fetch_sub(1) == 1) {
+                        done.set_value();
+                    }
+                });
+            });
+        });
+    }
+    done.get_future().wait();
+}
+
+// 任务中直接调用 pread, 线程阻塞在 I/O 上
+long long readBlocking(const std::string& dir)
+{
+    basic_pool<list_queue, cv_wait, future_task> pool(thread_number);
+    pool.init();
+    std::vector<std::future<long long>> results;
+    for (int id = 0; id < file_number; ++id) {
+        results.emplace_back(pool.append([&dir](int id) {
+            std::string path = dir + "/" + std::to_string(id);
+            int fd = open(path.c_str(), O_RDONLY);
+            std::vector<unsigned char> buf(file_size);
+            ssize_t n = pread(fd, buf.data(), file_size, 0);
+            close(fd);
+            return checksum(id, buf.data(), n);
+        }, id));
+    }
+    long long sum = 0;
+    for (auto& r : results) {
+        sum += r.get();
+    }
+    return sum;
+}
+
+// 任务中提交 async_read, 完成后的回调作为新任务执行
+long long readAsync(const std::string& dir)
+{
+    std::atomic<long long> sum{0};
+    std::atomic<int> remaining{file_number};
+    std::promise<void> done;
+    basic_pool<list_queue, cv_wait, detached_task, uring_io> pool(thread_number);
+    pool.init();
+    for (int id = 0; id < file_number; ++id) {
+        pool.append([&, id]() {
+            std::string path = dir + "/" + std::to_string(id);
+            int fd = open(path.c_str(), O_RDONLY);
+            auto buf = std::make_shared<std::vector<unsigned char>>(file_size);
+            async_read(fd, buf->data(), file_size, 0, [&, id, fd, buf](int res) {
+                close(fd);
+                assert(res == static_cast<int>(file_size));
+                sum.fetch_add(checksum(id, buf->data(), res));
+                if (remaining.fetch_sub(1) == 1) {
+                    done.set_value();
+                }
+            });
+        });
+    }
+    done.get_future().wait();
+    return sum.load();
+}
+
+template<typename F>
+double measure(F&& f, long long& result)
+{
+    auto start = std::chrono::steady_clock::now();
+    result = f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+int main() {
+    char pattern[] = "/tmp/bench_io_XXXXXX";
+    const char* dir = mkdtemp(pattern);
+    assert(dir);
+    createFiles(dir);
+
+    // 调用 async_* 的线程必须属于 uring_io 线程池
+    bool thrown = false;
+    try {
+        async_fsync(0, [](int) {});
+    } catch (const std::logic_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    long long blocking = 0, async = 0;
+    std::cout << "files: " << file_number << " x " << file_size / 1024 << " KB, threads: " << thread_number << std::endl;
+    std::cout << "blocking pread:\t" << measure([&]() { return readBlocking(dir); }, blocking) << " ms" << std::endl;
+    std::cout << "io_uring read:\t" << measure([&]() { return readAsync(dir); }, async) << " ms" << std::endl;
+    assert(blocking == async);
+
+    for (int id = 0; id < file_number; ++id) {
+        unlink((std::string(dir) + "/" + std::to_string(id)).c_str());
+    }
+    rmdir(dir);
+    return 0;
+}
@@ -0,0 +1,107 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <numeric>
+#include <cassert>
+#include "basic_pool.hpp"
+#include "pipeline.hpp"
+
+constexpr int thread_number = 4;        // 线程池中线程数量
+constexpr int item_number = 20000;      // 输入元素数量
+constexpr int item_size = 1024;         // 每个元素的数据量 (int)
+
+using clock_type = std::chrono::steady_clock;
+using pool_type = basic_pool<list_queue, cv_wait, future_task>;     // 任务中再次 append, 使用容量不限的队列
+
+struct chunk
+{
+    int id = 0;
+    std::vector<int> data;
+    long checksum = 0;
+};
+
+// parse -> transform -> compress, 每个阶段遍历一次数据
+void parse(chunk& c)
+{
+    c.data.resize(item_size);
+    std::iota(c.data.begin(), c.data.end(), c.id);
+}
+
+void transform(chunk& c)
+{
+    for (auto& v : c.data) {
+        v = v * 3 + 1;
+    }
+}
+
+void compress(chunk& c)
+{
+    c.checksum = std::accumulate(c.data.begin(), c.data.end(), 0L);
+}
+
+// 每个阶段通过 append 提交新任务, 写入阶段按顺序等待 future
+double benchAppend(long& total)
+{
+    pool_type pool(thread_number);
+    pool.init();
+    auto start = clock_type::now();
+    std::vector<std::future<std::future<std::future<chunk>>>> results;
+    results.reserve(item_number);
+    for (int i = 0; i < item_number; ++i) {
+        results.emplace_back(pool.append([&pool, i]() {
+            chunk c;
+            c.id = i;
+            parse(c);
+            return pool.append([&pool](chunk c) {
+                transform(c);
+                return pool.append([](chunk c) {
+                    compress(c);
+                    return c;
+                }, std::move(c));
+            }, std::move(c));
+        }));
+    }
+    total = 0;
+    for (auto& r : results) {
+        total += r.get().get().get().checksum;  // 写入阶段: 按输入顺序
+    }
+    auto end = clock_type::now();
+    pool.shutdown();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// 同样的阶段组成 pipeline, 最多 Tokens 个元素同时在流水线中
+template<size_t Tokens>
+double benchPipeline(long& total)
+{
+    pool_type pool(thread_number);
+    pool.init();
+    auto start = clock_type::now();
+    int next = 0;
+    total = 0;
+    pipeline<chunk, Tokens> p([&](chunk& c) {
+        if (next == item_number)
+            return false;
+        c.id = next++;
+        return true;
+    });
+    p.add_stage(stage_mode::parallel, parse)
+     .add_stage(stage_mode::parallel, transform)
+     .add_stage(stage_mode::parallel, compress)
+     .add_stage(stage_mode::serial_in_order, [&](chunk& c) { total += c.checksum; });
+    p.run(pool);
+    auto end = clock_type::now();
+    pool.shutdown();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+int main() {
+    long expect, total;
+    std::cout << "items: " << item_number << " x " << item_size * sizeof(int) << " bytes, threads: " << thread_number << std::endl;
+    std::cout << "append per stage  \t" << benchAppend(expect) << " ms" << std::endl;
+    std::cout << "pipeline, 8 tokens\t" << benchPipeline<8>(total) << " ms" << std::endl;
+    assert(total == expect);
+    std::cout << "pipeline, 64 tokens\t" << benchPipeline<64>(total) << " ms" << std::endl;
+    assert(total == expect);
+    return 0;
+}
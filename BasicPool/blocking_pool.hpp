@@ -0,0 +1,202 @@
+/*
+    blocking_pool: 执行长时间阻塞任务 (文件 I/O, sleep 等) 的弹性线程池
+    basic_pool::append_blocking 将任务交给内部的 blocking_pool, 避免阻塞任务占用固定数量的 CPU 线程
+
+    - 按需创建线程: 没有空闲线程且线程数小于 max_threads 时创建新线程, 否则任务排队
+    - 空闲超过 idle_timeout 的线程自动退出
+    - 返回值与 shutdown 语义与 basic_pool 相同: shutdown 后丢弃新任务, 已入队的任务执行完毕后线程退出
+*/
+#pragma once
+
+#include<list>
+#include<vector>
+#include<mutex>
+#include<thread>
+#include<chrono>
+#include<iterator>
+#include<stdexcept>
+#include<functional>
+#include<condition_variable>
+
+#include"pool_policies.hpp"
+
+template<typename TaskPolicy, typename ContextPolicy = no_context>
+class blocking_pool
+{
+public:
+    using context_type = typename ContextPolicy::context;
+    using task_type = typename TaskPolicy::template task_type<context_type>;
+
+    blocking_pool(int max_threads = 64, std::chrono::milliseconds idle_timeout = std::chrono::seconds(10));
+    ~blocking_pool();
+
+    // add a request to pool asynchronously
+    template <typename F, typename... Args>
+    decltype(auto) append(F &&, Args &&...);
+
+    void init();       // 允许 shutdown 之后重新接受任务
+    void shutdown();   // shutdown thread pool
+
+    // 修改线程数上限与空闲线程的回收时间
+    void set_limit(int max_threads, std::chrono::milliseconds idle_timeout);
+
+    int size() const;  // 当前线程数
+
+#pragma region delete copy and move
+    blocking_pool(const blocking_pool &) = delete;
+    blocking_pool(const blocking_pool &&) = delete;
+    blocking_pool &operator=(const blocking_pool &) = delete;
+    blocking_pool &operator=(const blocking_pool &&) = delete;
+#pragma endregion
+
+private:
+    using thread_iterator = typename std::list<std::thread>::iterator;
+
+    void threadFunc(thread_iterator self); // loop function for each thread
+    void push(task_type &&task);
+    void reap();                           // join 已退出的线程, 需持有 mutex_
+private:
+    std::list<std::thread> threads_;
+    std::vector<thread_iterator> finished_;    // 已退出但未 join 的线程
+    std::list<task_type> tasks_;
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stop_;
+    int live_;                                 // 未退出的线程数
+    int idle_;                                 // 正在等待任务的线程数
+    int max_threads_;
+    std::chrono::milliseconds idle_timeout_;
+};
+
+template<typename TaskPolicy, typename ContextPolicy>
+blocking_pool<TaskPolicy, ContextPolicy>::blocking_pool(int max_threads, std::chrono::milliseconds idle_timeout)
+    : stop_(false), live_(0), idle_(0), max_threads_(max_threads), idle_timeout_(idle_timeout)
+{
+    if (max_threads <= 0)
+    {
+        throw std::invalid_argument("blocking_pool: max_threads must be positive");
+    }
+}
+
+template<typename TaskPolicy, typename ContextPolicy>
+blocking_pool<TaskPolicy, ContextPolicy>::~blocking_pool()
+{
+    shutdown();
+}
+
+template<typename TaskPolicy, typename ContextPolicy>
+void blocking_pool<TaskPolicy, ContextPolicy>::init()
+{
+    std::lock_guard<std::mutex> guard(mutex_);
+    stop_ = false;
+}
+
+template<typename TaskPolicy, typename ContextPolicy>
+void blocking_pool<TaskPolicy, ContextPolicy>::shutdown()
+{
+    std::list<std::thread> threads;
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        stop_ = true;
+        threads.swap(threads_);                 // 迭代器仍然有效, 线程退出时可继续记录到 finished_
+    }
+    cv_.notify_all();
+    for (auto &thread : threads)
+    {
+        if (thread.joinable())
+        {
+            thread.join();
+        }
+    }
+    std::lock_guard<std::mutex> guard(mutex_);
+    finished_.clear();
+}
+
+template<typename TaskPolicy, typename ContextPolicy>
+void blocking_pool<TaskPolicy, ContextPolicy>::set_limit(int max_threads, std::chrono::milliseconds idle_timeout)
+{
+    if (max_threads <= 0)
+    {
+        throw std::invalid_argument("blocking_pool: max_threads must be positive");
+    }
+    std::lock_guard<std::mutex> guard(mutex_);
+    max_threads_ = max_threads;
+    idle_timeout_ = idle_timeout;
+}
+
+template<typename TaskPolicy, typename ContextPolicy>
+int blocking_pool<TaskPolicy, ContextPolicy>::size() const
+{
+    std::lock_guard<std::mutex> guard(mutex_);
+    return live_;
+}
+
+template<typename TaskPolicy, typename ContextPolicy>
+template <typename F, typename... Args>
+decltype(auto) blocking_pool<TaskPolicy, ContextPolicy>::append(F &&f, Args &&... args)
+{
+    return TaskPolicy::template submit<context_type>([this](task_type &&task) { push(std::move(task)); },
+        [func = std::bind(std::forward<F>(f), std::forward<Args>(args)...)](context_type &) mutable { return func(); });
+}
+
+template<typename TaskPolicy, typename ContextPolicy>
+void blocking_pool<TaskPolicy, ContextPolicy>::push(task_type &&task)
+{
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        if (stop_)
+            return;                                             // 丢弃任务
+        reap();
+        tasks_.emplace_back(std::move(task));
+        // 每个排队的任务对应一个空闲线程, 不够时创建新线程
+        if (static_cast<int>(tasks_.size()) > idle_ && live_ < max_threads_)
+        {
+            threads_.emplace_back();
+            auto self = std::prev(threads_.end());
+            *self = std::thread(&blocking_pool::threadFunc, this, self);
+            ++live_;
+            return;
+        }
+    }
+    cv_.notify_one();
+}
+
+template<typename TaskPolicy, typename ContextPolicy>
+void blocking_pool<TaskPolicy, ContextPolicy>::reap()
+{
+    for (auto &it : finished_)
+    {
+        it->join();
+        threads_.erase(it);
+    }
+    finished_.clear();
+}
+
+template<typename TaskPolicy, typename ContextPolicy>
+void blocking_pool<TaskPolicy, ContextPolicy>::threadFunc(thread_iterator self)
+{
+    context_type context;
+    std::unique_lock<std::mutex> guard(mutex_);
+    while (true)
+    {
+        if (!tasks_.empty())
+        {
+            task_type task = std::move(tasks_.front());
+            tasks_.pop_front();
+            guard.unlock();
+            task(context);
+            context.after_task();
+            guard.lock();
+            continue;
+        }
+        if (stop_)                                              // 队列已空且已关闭
+            break;
+        ++idle_;
+        bool ready = cv_.wait_for(guard, idle_timeout_, [this]() { return stop_ || !tasks_.empty(); });
+        --idle_;
+        if (!ready)                                             // 空闲超时, 线程退出
+            break;
+    }
+    --live_;
+    finished_.push_back(self);
+}
@@ -0,0 +1,422 @@
+/*
+    io_uring 异步 I/O 扩展
+    reference:
+        1. man io_uring_setup / io_uring_enter
+        2. https://kernel.dk/io_uring.pdf
+
+    使用 basic_pool<..., uring_io> 时每个线程拥有一个 io_uring 实例:
+    - 任务中调用 async_read / async_write / async_fsync 提交请求, 立即返回
+    - 线程在每次取任务前收割完成事件, 回调 callback(res) 作为新任务入队
+    - 队列为空而仍有未完成请求时, 线程在 io_uring 上短暂等待而不是休眠
+    res 与对应系统调用的返回值一致, 出错时为 -errno
+    回调按线程池的 TaskPolicy 封装: future_task 中回调抛出的异常被丢弃 (没有对应的 future),
+    detached_task 中与其他任务相同, 异常导致 std::terminate
+    内核不支持 io_uring, 或不支持 IORING_OP_READ / WRITE / FSYNC (< 5.6, 以 IORING_REGISTER_PROBE 检测) 时
+    退化为同步执行, 回调仍作为新任务入队
+*/
+#pragma once
+
+#include<linux/io_uring.h>
+#include<sys/syscall.h>
+#include<sys/mman.h>
+#include<sys/types.h>
+#include<unistd.h>
+#include<signal.h>
+#include<sched.h>
+#include<ctime>
+#include<cerrno>
+#include<cstring>
+#include<cstdint>
+#include<vector>
+#include<algorithm>
+#include<utility>
+#include<functional>
+#include<stdexcept>
+
+// 单线程使用的 io_uring, 由线程独占, 无需加锁
+class io_ring
+{
+public:
+    explicit io_ring(unsigned entries = 256)
+    {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        fd_ = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (fd_ < 0)
+            return;
+        features_ = params.features;
+
+        sq_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        if (features_ & IORING_FEAT_SINGLE_MMAP)
+        {
+            sq_size_ = cq_size_ = std::max(sq_size_, cq_size_);
+        }
+        sq_ptr_ = mmap(nullptr, sq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQ_RING);
+        cq_ptr_ = (features_ & IORING_FEAT_SINGLE_MMAP) ? sq_ptr_
+                : mmap(nullptr, cq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_CQ_RING);
+        sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+        void *sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES);
+        sqes_ = sqes == MAP_FAILED ? nullptr : static_cast<io_uring_sqe *>(sqes);
+        if (sq_ptr_ == MAP_FAILED || cq_ptr_ == MAP_FAILED || !sqes_)
+        {
+            release();
+            return;
+        }
+
+        char *sq = static_cast<char *>(sq_ptr_);
+        sq_head_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+        sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+        sq_mask_ = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+        sq_entries_ = params.sq_entries;
+        sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+        sq_local_tail_ = *sq_tail_;
+
+        char *cq = static_cast<char *>(cq_ptr_);
+        cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+
+        if (!probe())
+            release();      // 所需操作不可用, valid() 为 false, 请求同步执行
+    }
+
+    ~io_ring()
+    {
+        release();
+    }
+
+#pragma region copy and move delete
+    io_ring(const io_ring &) = delete;
+    io_ring &operator=(const io_ring &) = delete;
+    io_ring(io_ring &&) = delete;
+    io_ring &operator=(io_ring &&) = delete;
+#pragma endregion
+
+    bool valid() const { return fd_ >= 0; }
+
+    // 返回一个已清零的 sqe, SQ 已满时返回 nullptr
+    io_uring_sqe *get_sqe()
+    {
+        unsigned head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+        if (sq_local_tail_ - head >= sq_entries_)
+            return nullptr;
+        unsigned index = sq_local_tail_ & sq_mask_;
+        io_uring_sqe *sqe = &sqes_[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sq_array_[index] = index;
+        ++sq_local_tail_;
+        ++to_submit_;
+        return sqe;
+    }
+
+    // 提交所有未提交的 sqe
+    int submit()
+    {
+        if (to_submit_ == 0)
+            return 0;
+        return enter(0, 0, nullptr, _NSIG / 8);
+    }
+
+    // 提交并等待至少一个完成事件, 最多等待 timeout_ns
+    void wait(long timeout_ns)
+    {
+        if (!(features_ & IORING_FEAT_EXT_ARG))
+        {
+            wait_with_timeout_sqe(timeout_ns);
+            return;
+        }
+        __kernel_timespec ts;
+        ts.tv_sec = timeout_ns / 1000000000L;
+        ts.tv_nsec = timeout_ns % 1000000000L;
+        io_uring_getevents_arg arg;
+        std::memset(&arg, 0, sizeof(arg));
+        arg.ts = reinterpret_cast<uint64_t>(&ts);
+        enter(1, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));   // 超时返回 -ETIME
+    }
+
+    // 依次处理所有已完成的 cqe (不含 wait 内部的超时请求), 返回处理的数量
+    template<typename F>
+    unsigned for_each_cqe(F &&f)
+    {
+        unsigned head = *cq_head_;
+        unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+        unsigned count = 0;
+        for (; head != tail; ++head)
+        {
+            const io_uring_cqe &cqe = cqes_[head & cq_mask_];
+            if (cqe.user_data == timeout_user_data)
+            {
+                timeout_armed_ = false;
+                continue;
+            }
+            f(cqe);
+            ++count;
+        }
+        __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+        return count;
+    }
+
+private:
+    static constexpr uint64_t timeout_user_data = 0;    // 请求的 user_data 均为非空指针
+
+    // READ / WRITE / FSYNC 均可用时返回 true; IORING_REGISTER_PROBE 与 READ / WRITE 同在 5.6 加入, 更早的内核注册失败
+    bool probe()
+    {
+        constexpr unsigned probe_ops = 256;
+        std::vector<unsigned char> buffer(sizeof(io_uring_probe) + probe_ops * sizeof(io_uring_probe_op));
+        io_uring_probe *p = reinterpret_cast<io_uring_probe *>(buffer.data());
+        if (syscall(__NR_io_uring_register, fd_, IORING_REGISTER_PROBE, p, probe_ops) < 0)
+            return false;
+        for (uint8_t op : {IORING_OP_READ, IORING_OP_WRITE, IORING_OP_FSYNC})
+        {
+            if (op > p->last_op || !(p->ops[op].flags & IO_URING_OP_SUPPORTED))
+                return false;
+        }
+        return true;
+    }
+
+    // 没有 IORING_FEAT_EXT_ARG 的内核 (5.6 ~ 5.10): 以 IORING_OP_TIMEOUT 请求作为等待上限, 在 io_uring_enter 中阻塞
+    // 同时至多一个超时请求
+    void wait_with_timeout_sqe(long timeout_ns)
+    {
+        if (!timeout_armed_)
+        {
+            io_uring_sqe *sqe = get_sqe();
+            if (!sqe)
+            {
+                submit();
+                sqe = get_sqe();
+            }
+            if (sqe)
+            {
+                timeout_ts_.tv_sec = timeout_ns / 1000000000L;
+                timeout_ts_.tv_nsec = timeout_ns % 1000000000L;
+                sqe->opcode = IORING_OP_TIMEOUT;
+                sqe->fd = -1;
+                sqe->addr = reinterpret_cast<uint64_t>(&timeout_ts_);
+                sqe->len = 1;
+                sqe->off = 0;       // 不按完成数量触发, 只在超时后完成
+                sqe->user_data = timeout_user_data;
+                timeout_armed_ = true;
+            }
+        }
+        if (timeout_armed_)
+            enter(1, IORING_ENTER_GETEVENTS, nullptr, _NSIG / 8);
+        else
+            sched_yield();  // 提交后 SQ 仍满, 下次再等待
+    }
+
+    int enter(unsigned min_complete, unsigned flags, const void *arg, size_t argsz)
+    {
+        __atomic_store_n(sq_tail_, sq_local_tail_, __ATOMIC_RELEASE);
+        int ret = static_cast<int>(syscall(__NR_io_uring_enter, fd_, to_submit_, min_complete, flags, arg, argsz));
+        if (ret > 0)
+            to_submit_ -= std::min(to_submit_, static_cast<unsigned>(ret));
+        return ret;
+    }
+
+    void release()
+    {
+        if (sqes_)
+            munmap(sqes_, sqes_size_);
+        if (cq_ptr_ && cq_ptr_ != MAP_FAILED && cq_ptr_ != sq_ptr_)
+            munmap(cq_ptr_, cq_size_);
+        if (sq_ptr_ && sq_ptr_ != MAP_FAILED)
+            munmap(sq_ptr_, sq_size_);
+        if (fd_ >= 0)
+            close(fd_);
+        fd_ = -1;
+        sqes_ = nullptr;
+        sq_ptr_ = cq_ptr_ = nullptr;
+    }
+
+private:
+    int fd_ = -1;
+    unsigned features_ = 0;
+    void *sq_ptr_ = nullptr;
+    void *cq_ptr_ = nullptr;
+    size_t sq_size_ = 0;
+    size_t cq_size_ = 0;
+    size_t sqes_size_ = 0;
+    io_uring_sqe *sqes_ = nullptr;
+
+    unsigned *sq_head_ = nullptr;
+    unsigned *sq_tail_ = nullptr;
+    unsigned *sq_array_ = nullptr;
+    unsigned sq_mask_ = 0;
+    unsigned sq_entries_ = 0;
+    unsigned sq_local_tail_ = 0;     // 已填写但尚未对内核可见的 tail
+    unsigned to_submit_ = 0;
+
+    __kernel_timespec timeout_ts_{};
+    bool timeout_armed_ = false;        // 已提交的超时请求尚未完成
+
+    unsigned *cq_head_ = nullptr;
+    unsigned *cq_tail_ = nullptr;
+    unsigned cq_mask_ = 0;
+    io_uring_cqe *cqes_ = nullptr;
+};
+
+// IoPolicy: 每个线程一个 io_ring
+struct uring_io
+{
+    using callback_type = std::function<void(int)>;
+
+    class worker
+    {
+    public:
+        static constexpr unsigned ring_entries = 256;
+        static constexpr long wait_timeout_ns = 100 * 1000;   // 有未完成请求时的等待时长, 超时后重新检查任务队列
+
+        worker() : ring_(ring_entries) { current_() = this; }
+        ~worker() { current_() = nullptr; }
+
+        worker(const worker &) = delete;
+        worker &operator=(const worker &) = delete;
+
+        // 当前线程的 worker, 不在 uring_io 线程池中时为 nullptr
+        static worker *current() { return current_(); }
+
+        void read(int fd, void *buf, unsigned len, off_t offset, callback_type callback)
+        {
+            prepare(IORING_OP_READ, fd, buf, len, offset, std::move(callback));
+        }
+
+        void write(int fd, const void *buf, unsigned len, off_t offset, callback_type callback)
+        {
+            prepare(IORING_OP_WRITE, fd, buf, len, offset, std::move(callback));
+        }
+
+        void fsync(int fd, callback_type callback)
+        {
+            prepare(IORING_OP_FSYNC, fd, nullptr, 0, 0, std::move(callback));
+        }
+
+        // 提交新请求, 并将已完成请求的回调交给 sink 入队
+        template<typename Sink>
+        void reap(Sink &&sink)
+        {
+            if (!ready_.empty())
+            {
+                for (auto &done : ready_)
+                {
+                    sink(bind_result(std::move(done.first), done.second));
+                }
+                ready_.clear();
+            }
+            if (inflight_ == 0)
+                return;
+            ring_.submit();
+            ring_.for_each_cqe([this, &sink](const io_uring_cqe &cqe)
+            {
+                request *req = reinterpret_cast<request *>(cqe.user_data);
+                --inflight_;
+                sink(bind_result(std::move(req->callback), cqe.res));
+                delete req;
+            });
+        }
+
+        bool pending() const { return inflight_ != 0 || !ready_.empty(); }
+
+        void wait_completion()
+        {
+            if (inflight_ != 0)
+                ring_.wait(wait_timeout_ns);
+        }
+
+    private:
+        struct request
+        {
+            callback_type callback;
+        };
+
+        static worker *&current_()
+        {
+            static thread_local worker *w = nullptr;
+            return w;
+        }
+
+        static auto bind_result(callback_type &&callback, int res)
+        {
+            return [callback = std::move(callback), res]() { callback(res); };
+        }
+
+        void prepare(uint8_t opcode, int fd, const void *buf, unsigned len, off_t offset, callback_type &&callback)
+        {
+            io_uring_sqe *sqe = ring_.valid() ? ring_.get_sqe() : nullptr;
+            if (!sqe && ring_.valid())
+            {
+                ring_.submit();     // SQ 已满, 先提交再重试
+                sqe = ring_.get_sqe();
+            }
+            if (!sqe)
+            {
+                ready_.emplace_back(std::move(callback), execute(opcode, fd, buf, len, offset));
+                return;
+            }
+            sqe->opcode = opcode;
+            sqe->fd = fd;
+            sqe->addr = reinterpret_cast<uint64_t>(buf);
+            sqe->len = len;
+            sqe->off = static_cast<uint64_t>(offset);
+            sqe->user_data = reinterpret_cast<uint64_t>(new request{std::move(callback)});
+            ++inflight_;
+        }
+
+        // 同步执行, 用于 io_uring 不可用时
+        static int execute(uint8_t opcode, int fd, const void *buf, unsigned len, off_t offset)
+        {
+            ssize_t ret = 0;
+            switch (opcode)
+            {
+            case IORING_OP_READ:
+                ret = pread(fd, const_cast<void *>(buf), len, offset);
+                break;
+            case IORING_OP_WRITE:
+                ret = pwrite(fd, buf, len, offset);
+                break;
+            case IORING_OP_FSYNC:
+                ret = ::fsync(fd);
+                break;
+            }
+            return ret < 0 ? -errno : static_cast<int>(ret);
+        }
+
+    private:
+        io_ring ring_;
+        size_t inflight_ = 0;
+        std::vector<std::pair<callback_type, int>> ready_;  // 同步执行的结果
+    };
+};
+
+#pragma region async io api
+// 以下函数只能在 basic_pool<..., uring_io> 的任务中调用
+template<typename F>
+void async_read(int fd, void *buf, unsigned len, off_t offset, F &&callback)
+{
+    uring_io::worker *io = uring_io::worker::current();
+    if (!io)
+        throw std::logic_error("async_read: not called from a uring_io pool task");
+    io->read(fd, buf, len, offset, std::forward<F>(callback));
+}
+
+template<typename F>
+void async_write(int fd, const void *buf, unsigned len, off_t offset, F &&callback)
+{
+    uring_io::worker *io = uring_io::worker::current();
+    if (!io)
+        throw std::logic_error("async_write: not called from a uring_io pool task");
+    io->write(fd, buf, len, offset, std::forward<F>(callback));
+}
+
+template<typename F>
+void async_fsync(int fd, F &&callback)
+{
+    uring_io::worker *io = uring_io::worker::current();
+    if (!io)
+        throw std::logic_error("async_fsync: not called from a uring_io pool task");
+    io->fsync(fd, std::forward<F>(callback));
+}
+#pragma endregion
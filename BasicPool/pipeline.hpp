@@ -0,0 +1,351 @@
+/*
+    pipeline: 在 basic_pool 上运行的多阶段流水线, 如 parse -> transform -> compress -> write
+        pipeline<chunk, 16> p([&](chunk& c) { return read(c); });   // 输入阶段, 输入结束时返回 false
+        p.add_stage(stage_mode::parallel, parse)
+         .add_stage(stage_mode::serial_out_of_order, transform)
+         .add_stage(stage_mode::serial_in_order, write);
+        p.run(pool);                                                // 阻塞直到所有元素处理完毕
+
+    - parallel: 多个元素可同时处理
+    - serial_out_of_order: 同一时刻只处理一个元素, 顺序任意
+    - serial_in_order: 同一时刻只处理一个元素, 按输入顺序
+    - Tokens 为同时在流水线中的元素数上限; 预先构造 Tokens 个 T, 处理完的元素归还后用于下一次输入,
+      T 中的缓冲区在元素之间复用, 内存占用有上限
+    - 一个线程取得输入后连续执行后续阶段, 数据留在该线程的 cache 中; 串行阶段正忙时元素进入该阶段的有界等待队列,
+      由正在执行该阶段的线程处理后作为新任务提交到 pool, 每个元素不产生 future
+    - 阶段抛出异常后停止读取输入, 其余元素跳过剩余阶段, run 重新抛出第一个异常
+
+    注意: run 不能在 pool 的线程中调用; run 返回前不能 shutdown pool; pool 的任务队列容量应大于 Tokens
+*/
+#pragma once
+
+#include<array>
+#include<mutex>
+#include<thread>
+#include<atomic>
+#include<memory>
+#include<vector>
+#include<cstddef>
+#include<utility>
+#include<exception>
+#include<functional>
+#include<condition_variable>
+
+#include"../LockFreePool/lockfreequeue.hpp"
+
+enum class stage_mode
+{
+    serial_in_order,
+    serial_out_of_order,
+    parallel
+};
+
+template<typename T, size_t Tokens = 16>
+class pipeline
+{
+    static_assert(Tokens > 0, "pipeline requires at least one token");
+public:
+    using input_type = std::function<bool(T &)>;   // 填充下一个元素, 输入结束时返回 false
+    using stage_type = std::function<void(T &)>;
+
+    explicit pipeline(input_type input);
+
+    pipeline &add_stage(stage_mode mode, stage_type func);
+
+    template<typename Pool>
+    void run(Pool &pool);
+
+#pragma region delete copy and move
+    pipeline(const pipeline &) = delete;
+    pipeline(const pipeline &&) = delete;
+    pipeline &operator=(const pipeline &) = delete;
+    pipeline &operator=(const pipeline &&) = delete;
+#pragma endregion
+
+private:
+    struct item
+    {
+        T value;
+        size_t seq;             // 输入顺序, serial_in_order 阶段按此排序
+    };
+
+    struct stage
+    {
+        stage(stage_mode m, stage_type f);
+
+        void deposit(item *x);  // 元素进入等待队列
+        bool take(item *&x);    // 取出下一个可处理的元素, 需持有 busy; 元素正在放入时等待其完成
+        bool ready() const;     // 是否有可处理的元素
+
+        stage_mode mode;
+        stage_type func;
+        std::atomic<bool> busy;                             // 串行阶段的执行权
+        CircularQueue<item *, Tokens> queue;                // serial_out_of_order 的等待队列
+        std::array<std::atomic<item *>, Tokens> reorder;    // serial_in_order 的等待元素, 以 seq % Tokens 为下标
+        std::atomic<size_t> next;                           // serial_in_order 下一个应处理的 seq
+    };
+
+    void advance(item *x, size_t index);    // 从第 index 个阶段开始处理 x, x 为空时读取新的输入
+    item *take_input();                     // 读取一个输入, 没有可用 token 或输入结束时返回空
+    item *enter_serial(stage &s, size_t index, item *x);   // 返回已通过该阶段、由当前线程继续处理的元素
+    void call(stage &s, item *x);
+    void fail(std::exception_ptr error);
+    static bool pop(CircularQueue<item *, Tokens> &queue, item *&x);  // 队列非空时等待正在放入的元素写入完成
+private:
+    input_type input_;
+    std::vector<std::unique_ptr<stage>> stages_;
+    std::unique_ptr<item[]> items_;
+    CircularQueue<item *, Tokens> free_;    // 空闲 token
+    std::atomic<bool> input_busy_;
+    bool exhausted_;                        // 输入已结束, 需持有 input_busy_
+    size_t next_seq_;                       // 需持有 input_busy_
+    std::atomic<bool> cancelled_;
+    std::atomic<size_t> retired_;           // 输入结束后不再使用的 token 数
+    std::atomic<size_t> active_;            // 已提交但未返回的 advance 任务数
+    std::atomic<bool> pump_pending_;        // 已提交但未开始的读取输入任务, 至多一个
+    std::function<void(item *, size_t)> spawn_;
+    std::exception_ptr error_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool done_;
+};
+
+template<typename T, size_t Tokens>
+pipeline<T, Tokens>::stage::stage(stage_mode m, stage_type f)
+    : mode(m), func(std::move(f)), busy(false), next(0)
+{
+    for (auto &slot : reorder)
+    {
+        slot.store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+template<typename T, size_t Tokens>
+void pipeline<T, Tokens>::stage::deposit(item *x)
+{
+    if (mode == stage_mode::serial_in_order)
+        reorder[x->seq % Tokens].store(x);
+    else
+        queue.push(x);                      // 同时在流水线中的元素不超过 Tokens, 不会满
+}
+
+template<typename T, size_t Tokens>
+bool pipeline<T, Tokens>::stage::take(item *&x)
+{
+    if (mode == stage_mode::serial_out_of_order)
+        return pop(queue, x);
+    size_t seq = next.load();
+    x = reorder[seq % Tokens].exchange(nullptr);
+    if (x == nullptr)
+        return false;
+    next.store(seq + 1);
+    return true;
+}
+
+template<typename T, size_t Tokens>
+bool pipeline<T, Tokens>::stage::ready() const
+{
+    if (mode == stage_mode::serial_out_of_order)
+        return !queue.empty();
+    return reorder[next.load() % Tokens].load() != nullptr;
+}
+
+template<typename T, size_t Tokens>
+pipeline<T, Tokens>::pipeline(input_type input)
+    : input_(std::move(input)), items_(new item[Tokens]), input_busy_(false), exhausted_(false), next_seq_(0),
+      cancelled_(false), retired_(0), active_(0), pump_pending_(false), done_(false)
+{
+}
+
+template<typename T, size_t Tokens>
+pipeline<T, Tokens> &pipeline<T, Tokens>::add_stage(stage_mode mode, stage_type func)
+{
+    stages_.emplace_back(new stage(mode, std::move(func)));
+    return *this;
+}
+
+template<typename T, size_t Tokens>
+template<typename Pool>
+void pipeline<T, Tokens>::run(Pool &pool)
+{
+    exhausted_ = false;
+    next_seq_ = 0;
+    cancelled_.store(false);
+    retired_.store(0);
+    done_ = false;
+    for (auto &s : stages_)
+    {
+        s->next.store(0);
+    }
+    for (size_t i = 0; i < Tokens; ++i)
+    {
+        free_.push(&items_[i]);
+    }
+    spawn_ = [this, &pool](item *x, size_t index)
+    {
+        active_.fetch_add(1);
+        pool.append(&pipeline::advance, this, x, index);
+    };
+
+    pump_pending_.store(true);
+    spawn_(nullptr, 0);
+    {
+        std::unique_lock<std::mutex> guard(mutex_);
+        cv_.wait(guard, [this]() { return done_; });
+    }
+    spawn_ = nullptr;
+    if (error_)
+    {
+        std::rethrow_exception(std::exchange(error_, nullptr));
+    }
+}
+
+template<typename T, size_t Tokens>
+void pipeline<T, Tokens>::advance(item *x, size_t index)
+{
+    if (x == nullptr)
+        pump_pending_.store(false);
+    while (true)
+    {
+        if (x == nullptr)
+        {
+            x = take_input();
+            if (x == nullptr)
+                break;
+            index = 0;
+        }
+        // 在当前线程上连续执行后续阶段, 串行阶段正忙时 x 留在该阶段的等待队列中
+        for (; index < stages_.size() && x != nullptr; ++index)
+        {
+            stage &s = *stages_[index];
+            if (s.mode == stage_mode::parallel)
+                call(s, x);
+            else
+                x = enter_serial(s, index, x);
+        }
+        if (x != nullptr)
+        {
+            free_.push(x);                  // 元素处理完毕, 归还 token
+            x = nullptr;
+        }
+    }
+
+    // 最后一个任务在所有 token 回收后通知 run
+    if (active_.fetch_sub(1) == 1 && retired_.load() == Tokens)
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        done_ = true;
+        cv_.notify_all();
+    }
+}
+
+template<typename T, size_t Tokens>
+typename pipeline<T, Tokens>::item *pipeline<T, Tokens>::take_input()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    item *keep = nullptr;
+    while (!input_busy_.exchange(true))
+    {
+        item *x;
+        while (keep == nullptr && pop(free_, x))
+        {
+            bool more = false;
+            if (!exhausted_ && !cancelled_.load())
+            {
+                try
+                {
+                    more = input_(x->value);
+                }
+                catch (...)
+                {
+                    fail(std::current_exception());
+                }
+            }
+            if (more)
+            {
+                x->seq = next_seq_++;
+                keep = x;
+            }
+            else
+            {
+                exhausted_ = true;
+                retired_.fetch_add(1);
+            }
+        }
+        input_busy_.store(false);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        // 释放后重新检查: 持有 input_busy_ 期间归还 token 的线程获取执行权失败, 只能由当前线程处理
+        if (free_.empty())
+            break;
+        if (keep != nullptr)
+        {
+            if (!pump_pending_.exchange(true))
+                spawn_(nullptr, 0);         // 还有空闲 token, 由另一个线程读取下一个输入
+            break;
+        }
+    }
+    return keep;
+}
+
+template<typename T, size_t Tokens>
+typename pipeline<T, Tokens>::item *pipeline<T, Tokens>::enter_serial(stage &s, size_t index, item *x)
+{
+    s.deposit(x);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    item *keep = nullptr;
+    while (!s.busy.exchange(true))
+    {
+        item *y;
+        while (s.take(y))
+        {
+            call(s, y);
+            if (keep == nullptr)
+                keep = y;                   // 当前线程继续处理第一个元素
+            else
+                spawn_(y, index + 1);
+        }
+        s.busy.store(false);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        // 释放后重新检查: 持有 busy 期间放入元素的线程获取执行权失败, 只能由当前线程处理
+        if (!s.ready())
+            break;
+    }
+    return keep;
+}
+
+template<typename T, size_t Tokens>
+void pipeline<T, Tokens>::call(stage &s, item *x)
+{
+    if (cancelled_.load(std::memory_order_relaxed))
+        return;
+    try
+    {
+        s.func(x->value);
+    }
+    catch (...)
+    {
+        fail(std::current_exception());
+    }
+}
+
+template<typename T, size_t Tokens>
+bool pipeline<T, Tokens>::pop(CircularQueue<item *, Tokens> &queue, item *&x)
+{
+    // tail_ 已前移而元素尚未写入时 pop 失败但 empty() 为 false, 写入者随后会完成, 让出时间片等待
+    while (!queue.pop(x))
+    {
+        if (queue.empty())
+            return false;
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+template<typename T, size_t Tokens>
+void pipeline<T, Tokens>::fail(std::exception_ptr error)
+{
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (!error_)
+        error_ = error;
+    cancelled_.store(true);
+}
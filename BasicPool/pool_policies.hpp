@@ -0,0 +1,251 @@
+/*
+    Policies for basic_pool
+    每个 policy 都是普通的类/类模板, basic_pool 通过模板参数静态选择, 不涉及虚函数调用
+
+    QueuePolicy: 提供 template<typename T> queue, 需实现
+        template<typename U> bool push(U&&);   // 队列满时返回 false, 此时不移动参数; U 为 submit 交给 sink 的可调用对象
+        bool pop(T&);                          // 队列空时返回 false
+        bool empty() const;
+        可以用 bool consume(Context&) 代替 pop: 取出任务并在队列中原地执行 (如 inline_queue)
+
+    WaitPolicy: 空闲线程的等待方式, 每个线程一个实例, 需实现
+        template<typename Pred> void wait(Pred&&);   // 阻塞直到 pred() 为 true
+        bool notify_one();                           // push 之后调用; 线程没有在等待或已被唤醒时返回 false, 调用者转而唤醒其他线程
+        void notify_all();                           // shutdown 时调用
+
+    TaskPolicy: 用户函数如何封装为队列中的任务, 需实现
+        template<typename Context> using task_type;       // 队列元素类型, 以 task(context&) 调用
+        template<typename Context, typename Sink, typename F>
+        static ??? submit(Sink&&, F&&);                   // 将 f(context&) 封装为可调用对象交给 sink 入队, 返回值即 append 的返回值
+                                                          // 由队列将其转换为 task_type 或直接存储
+
+    IoPolicy: 每个线程的异步 I/O 状态, 提供 class worker, 在线程函数中构造, 需实现
+        template<typename Sink> void reap(Sink&&);   // 将已完成 I/O 的回调(无参可调用对象)交给 sink 入队
+        bool pending() const;                        // 是否有未完成的 I/O
+        void wait_completion();                      // 等待 I/O 完成, 可超时返回
+        默认为 no_io, io_uring 实现见 io_uring.hpp
+
+    ContextPolicy: 每个线程的本地上下文, 提供 class context, 在线程函数中默认构造, 需实现
+        void after_task();                           // 每个任务执行后调用
+        默认为 no_context, 其余实现见 worker_context.hpp
+*/
+#pragma once
+
+#include<list>
+#include<mutex>
+#include<memory>
+#include<thread>
+#include<future>
+#include<atomic>
+#include<functional>
+#include<type_traits>
+#include<condition_variable>
+
+#include"../LockFreePool/lockfreequeue.hpp"
+#include"../LockFreePool/inline_queue.hpp"
+
+#pragma region queue policies
+// std::list + mutex, 原 threadpool 的任务队列, 容量不限
+struct list_queue
+{
+    template<typename T>
+    class queue
+    {
+    public:
+        template<typename U>
+        bool push(U &&value)
+        {
+            std::lock_guard<std::mutex> guard(mutex_);
+            list_.emplace_back(std::forward<U>(value));
+            return true;
+        }
+
+        bool pop(T &value)
+        {
+            std::lock_guard<std::mutex> guard(mutex_);
+            if (list_.empty())
+                return false;
+            value = std::move(list_.front());   // 使用move语义，减少拷贝构造函数的调用
+            list_.pop_front();
+            return true;
+        }
+
+        bool empty() const
+        {
+            std::lock_guard<std::mutex> guard(mutex_);
+            return list_.empty();
+        }
+
+    private:
+        std::list<T> list_;
+        mutable std::mutex mutex_;
+    };
+};
+
+// CircularQueue, 原 LockFreePool 的任务队列, 容量固定为 Cap
+// Alloc 为环形缓冲区的分配器, 如 huge_page_allocator (见 LockFreePool/huge_page_allocator.hpp)
+template<size_t Cap, template<typename> class Alloc = std::allocator>
+struct circular_queue
+{
+    template<typename T>
+    using queue = CircularQueue<T, Cap, Alloc<T>>;
+};
+
+// InlineQueue, 闭包以变长记录直接写入 Bytes 字节的环形缓冲区并在其中原地执行, 不经过 std::function
+// 每个任务没有堆分配 (future_task 的共享状态除外), Bytes 须为 64 的 2 的幂倍
+template<size_t Bytes>
+struct inline_queue
+{
+    template<typename T>
+    struct signature;
+    template<typename Signature>
+    struct signature<std::function<Signature>>
+    {
+        using type = Signature;
+    };
+
+    template<typename T>
+    using queue = InlineQueue<typename signature<T>::type, Bytes>;
+};
+#pragma endregion
+
+#pragma region wait policies
+// 忙等, 延迟最低, 但空闲线程会占满 CPU
+struct spin_wait
+{
+    template<typename Pred>
+    void wait(Pred &&ready)
+    {
+        while (!ready()) {}
+    }
+    bool notify_one() { return true; }      // 线程自行轮询, 无需唤醒
+    void notify_all() {}
+};
+
+// 忙等, 但每次检查失败后让出时间片
+struct yield_wait
+{
+    template<typename Pred>
+    void wait(Pred &&ready)
+    {
+        while (!ready())
+        {
+            std::this_thread::yield();
+        }
+    }
+    bool notify_one() { return true; }      // 线程自行轮询, 无需唤醒
+    void notify_all() {}
+};
+
+// 条件变量, 空闲线程休眠; 每个实例只有一个等待线程 (basic_pool 的每个线程一个实例)
+// sleeping_ 在线程休眠期间为 true, notify_one 以 exchange 认领后置为 false, 认领之后到线程醒来之前的 notify_one 返回 false,
+// 使调用者转而唤醒其他线程; 没有等待者时 notify_one / notify_all 不加锁
+class cv_wait
+{
+public:
+    template<typename Pred>
+    void wait(Pred &&ready)
+    {
+        std::unique_lock<std::mutex> guard(mutex_);
+        while (true)
+        {
+            // 每次休眠前重新置位: 被唤醒后任务可能已被其他线程取走, 再次休眠时须能被再次认领
+            sleeping_.store(true, std::memory_order_relaxed);
+            // 与 notify_one 中的 fence 配对: 要么生产者看到 sleeping_, 要么这里的 ready() 看到新任务
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (ready())
+                break;
+            cv_.wait(guard);
+        }
+        sleeping_.store(false, std::memory_order_relaxed);
+    }
+
+    bool notify_one()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!sleeping_.load(std::memory_order_relaxed) || !sleeping_.exchange(false))
+            return false;                               // 没有在等待, 或已被其他生产者唤醒
+        {
+            std::lock_guard<std::mutex> guard(mutex_);  // 防止在 wait 检查 ready() 与休眠之间丢失通知
+        }
+        cv_.notify_one();
+        return true;
+    }
+
+    void notify_all()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!sleeping_.exchange(false))
+            return;
+        {
+            std::lock_guard<std::mutex> guard(mutex_);
+        }
+        cv_.notify_all();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::atomic<bool> sleeping_{false};
+};
+#pragma endregion
+
+#pragma region task policies
+// packaged_task + future, 可异步获取返回值
+// 任务被丢弃(如 shutdown 之后提交)时 future.get() 抛出 broken_promise
+struct future_task
+{
+    template<typename Context>
+    using task_type = std::function<void(Context &)>;
+
+    template<typename Context, typename Sink, typename F>
+    static decltype(auto) submit(Sink &&sink, F &&func)
+    {
+        using return_type = std::invoke_result_t<std::decay_t<F> &, Context &>;
+
+        // use shared_ptr so that the wrapper stays copy constructible for std::function
+        auto task_ptr = std::make_shared<std::packaged_task<return_type(Context &)>>(std::forward<F>(func));
+        auto result = task_ptr->get_future();
+        sink([task_ptr](Context &context) { (*task_ptr)(context); });
+        return result;
+    }
+};
+
+// 不关心返回值, 省去 packaged_task 与共享状态的分配; 任务抛出异常将导致 std::terminate
+struct detached_task
+{
+    template<typename Context>
+    using task_type = std::function<void(Context &)>;
+
+    template<typename Context, typename Sink, typename F>
+    static void submit(Sink &&sink, F &&func)
+    {
+        sink(std::forward<F>(func));
+    }
+};
+#pragma endregion
+
+#pragma region io policies
+// 不提供异步 I/O, 线程函数中的相关调用均为空操作
+struct no_io
+{
+    struct worker
+    {
+        template<typename Sink>
+        void reap(Sink &&) {}
+        bool pending() const { return false; }
+        void wait_completion() {}
+    };
+};
+#pragma endregion
+
+#pragma region context policies
+// 没有线程本地上下文
+struct no_context
+{
+    struct context
+    {
+        void after_task() {}
+    };
+};
+#pragma endregion
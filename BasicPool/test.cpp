@@ -0,0 +1,402 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <thread>
+#include <cassert>
+#include <array>
+#include <algorithm>
+#include "basic_pool.hpp"
+#include "io_uring.hpp"
+#include "worker_context.hpp"
+#include "pipeline.hpp"
+#include "../LockFreePool/huge_page_allocator.hpp"
+
+constexpr int thread_number = 4;    // 线程池中线程数量
+constexpr int task_number = 100000; // 每种组合提交的任务数量
+
+// 提交 task_number 个任务并检查返回值, 返回耗时(ms)
+template<typename QueuePolicy, typename WaitPolicy>
+double benchFuture()
+{
+    basic_pool<QueuePolicy, WaitPolicy, future_task> pool(thread_number);
+    pool.init();
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::future<int>> results;
+    results.reserve(task_number);
+    for (int i = 0; i < task_number; ++i) {
+        results.emplace_back(pool.append([](int a, int b) { return a + b; }, i, 1));
+    }
+    for (int i = 0; i < task_number; ++i) {
+        assert(results[i].get() == i + 1);
+    }
+    auto end = std::chrono::steady_clock::now();
+    pool.shutdown();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// detached_task 无返回值, 通过 shutdown 等待队列中的任务执行完毕
+template<typename QueuePolicy, typename WaitPolicy>
+double benchDetached()
+{
+    std::atomic<int> counter{0};
+    basic_pool<QueuePolicy, WaitPolicy, detached_task> pool(thread_number);
+    pool.init();
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < task_number; ++i) {
+        pool.append([&counter]() { counter.fetch_add(1, std::memory_order_relaxed); });
+    }
+    pool.shutdown();
+    auto end = std::chrono::steady_clock::now();
+    assert(counter.load() == task_number);
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+template<typename QueuePolicy, typename WaitPolicy>
+void bench(const char* name)
+{
+    std::cout << name << "\tfuture: " << benchFuture<QueuePolicy, WaitPolicy>() << " ms"
+              << "\tdetached: " << benchDetached<QueuePolicy, WaitPolicy>() << " ms" << std::endl;
+}
+
+void testSemantics()
+{
+    // thread_number <= 0 抛出异常
+    bool thrown = false;
+    try {
+        basic_pool<list_queue, cv_wait, future_task> pool(0);
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // init 之前提交的任务在 init 之后执行
+    basic_pool<circular_queue<16>, cv_wait, future_task> pool(2);
+    auto f = pool.append([]() { return 42; });
+    pool.init();
+    assert(f.get() == 42);
+
+    // shutdown 之后提交的任务被丢弃
+    pool.shutdown();
+    pool.shutdown();
+    auto g = pool.append([]() { return 0; });
+    thrown = false;
+    try {
+        g.get();
+    } catch (const std::future_error& e) {
+        thrown = e.code() == std::future_errc::broken_promise;
+    }
+    assert(thrown);
+
+    // 可以再次 init
+    pool.init();
+    assert(pool.append([](int x) { return x * 2; }, 21).get() == 42);
+}
+
+// 突发提交的阻塞任务分散到所有线程, 已被唤醒而尚未醒来的线程不会被重复选中
+void testBurst()
+{
+    basic_pool<list_queue, cv_wait, future_task> pool(thread_number);
+    pool.init(true);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));    // 所有线程进入休眠
+    std::vector<std::future<std::thread::id>> results;
+    for (int i = 0; i < 4 * thread_number; ++i) {
+        results.emplace_back(pool.append([]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            return std::this_thread::get_id();
+        }));
+    }
+    std::vector<std::thread::id> ids;
+    for (auto& r : results) {
+        ids.push_back(r.get());
+    }
+    std::sort(ids.begin(), ids.end());
+    assert(std::unique(ids.begin(), ids.end()) - ids.begin() == thread_number);    // 所有线程均被唤醒
+}
+
+void testContext()
+{
+    std::atomic<int> started{0}, stopped{0};
+    basic_pool<list_queue, cv_wait, future_task, no_io, arena_context<4096>> pool(2);
+    pool.on_start([&](int index, worker_arena& arena) {
+        assert(index >= 0 && index < 2 && arena.capacity() == 4096);
+        started.fetch_add(1);
+    });
+    pool.on_stop([&](int, worker_arena&) { stopped.fetch_add(1); });
+    pool.init();
+
+    // 每个任务开始时 arena 已被重置, 同一线程上的任务得到相同的地址; arena 中的内存不离开任务
+    std::vector<std::future<std::pair<std::thread::id, uintptr_t>>> results;
+    for (int i = 0; i < 100; ++i) {
+        results.emplace_back(pool.append_with_context([](worker_arena& arena, int n) {
+            assert(arena.used() == 0);
+            int* buf = arena.allocate_array<int>(n);
+            long sum = 0;
+            for (int j = 0; j < n; ++j) {
+                buf[j] = j;
+            }
+            for (int j = 0; j < n; ++j) {
+                sum += buf[j];
+            }
+            assert(sum == static_cast<long>(n) * (n - 1) / 2);
+            return std::make_pair(std::this_thread::get_id(), reinterpret_cast<uintptr_t>(buf));
+        }, 1000));
+    }
+    std::vector<std::pair<std::thread::id, uintptr_t>> first;   // 每个线程第一个任务的地址
+    for (auto& r : results) {
+        auto [id, addr] = r.get();
+        auto it = std::find_if(first.begin(), first.end(), [id = id](const auto& p) { return p.first == id; });
+        if (it == first.end()) {
+            first.emplace_back(id, addr);
+        } else {
+            assert(it->second == addr);
+        }
+    }
+    assert(!first.empty() && first.size() <= 2);
+    // 不需要上下文的任务照常提交
+    assert(pool.append([](int a) { return a; }, 7).get() == 7);
+
+    pool.shutdown();
+    assert(started.load() == 2 && stopped.load() == 2);
+}
+
+void testBlocking()
+{
+    blocking_pool<future_task> blocking(4, std::chrono::milliseconds(50));
+    std::vector<std::future<int>> results;
+    for (int i = 0; i < 8; ++i) {
+        results.emplace_back(blocking.append([](int x) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            return x;
+        }, i));
+    }
+    assert(blocking.size() == 4);       // 线程数不超过上限
+    for (int i = 0; i < 8; ++i) {
+        assert(results[i].get() == i);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    assert(blocking.size() == 0);       // 空闲线程已退出
+
+    // append_blocking 与 append 的返回值及 shutdown 语义相同
+    basic_pool<list_queue, cv_wait, future_task> pool(2);
+    pool.init();
+    auto f = pool.append_blocking([]() { return 1; });
+    auto g = pool.append([]() { return 2; });
+    assert(f.get() + g.get() == 3);
+    pool.shutdown();
+    bool thrown = false;
+    try {
+        pool.append_blocking([]() { return 0; }).get();
+    } catch (const std::future_error& e) {
+        thrown = e.code() == std::future_errc::broken_promise;
+    }
+    assert(thrown);
+}
+
+void testHugePages()
+{
+    CircularQueue<int, 1000, huge_page_allocator<int>> q;
+    for (int i = 0; i < 1000; ++i) {
+        assert(q.push(i));
+    }
+    assert(!q.push(1000));
+    for (int i = 0; i < 1000; ++i) {
+        int val;
+        assert(q.pop(val) && val == i);
+    }
+
+    // 任务队列与 arena 均使用大页, init(true) 返回时所有线程已完成启动
+    std::atomic<int> started{0};
+    basic_pool<circular_queue<4096, huge_page_allocator>, cv_wait, future_task, no_io, arena_context<1024 * 1024, true>> pool(2);
+    pool.on_start([&](int, worker_arena& arena) {
+        assert(reinterpret_cast<uintptr_t>(arena.allocate(1)) % huge_page_allocator<char>::huge_page_size == 0);
+        started.fetch_add(1);
+    });
+    pool.init(true);
+    assert(started.load() == 2);
+    auto f = pool.append_with_context([](worker_arena& arena) {
+        return arena.allocate_array<char>(512 * 1024) != nullptr;
+    });
+    assert(f.get());
+}
+
+void testIo()
+{
+    // I/O 回调抛出的异常不会终止线程, 之后的任务与回调照常执行
+    basic_pool<list_queue, cv_wait, future_task, uring_io> pool(1);
+    pool.init();
+    FILE* file = std::tmpfile();
+    assert(file != nullptr);
+    int fd = fileno(file);
+    static const char data[] = "io";
+    std::promise<int> written;
+    pool.append([&]() {
+        async_write(fd, data, 2, 0, [](int) { throw std::runtime_error("callback failed"); });
+        async_write(fd, data, 2, 2, [&](int res) { written.set_value(res); });
+    });
+    assert(written.get_future().get() == 2);
+    assert(pool.append([]() { return 1; }).get() == 1);
+    pool.shutdown();
+    std::fclose(file);
+}
+
+// 统计闭包中捕获的对象, 检查记录执行后以及队列析构时均被析构
+struct tracked
+{
+    static inline std::atomic<int> live{0};
+    tracked() { live.fetch_add(1); }
+    tracked(const tracked&) { live.fetch_add(1); }
+    ~tracked() { live.fetch_sub(1); }
+};
+
+void testInlineQueue()
+{
+    {
+        InlineQueue<void(long&), 1024> q;     // 16 个 cell
+        std::array<char, 200> big{};            // 占用 4 个 cell
+        big[0] = 1;
+        long sum = 0, expect = 0;
+        // 大小不同的记录交替写入, 多次绕回缓冲区开头
+        for (int i = 0; i < 1000; ++i) {
+            tracked t;
+            assert(q.push([t, i](long& s) { s += i; }));
+            assert(q.push([big, i](long& s) { s += i * big[0]; }));
+            expect += 2 * i;
+            if (i % 3 == 0) {
+                continue;
+            }
+            while (q.consume(sum)) {
+            }
+        }
+        while (q.consume(sum)) {
+        }
+        assert(sum == expect && tracked::live.load() == 0);
+
+        // 队列满时 push 返回 false
+        int pushed = 0;
+        while (q.push([big](long& s) { s += big[0]; })) {
+            ++pushed;
+        }
+        assert(pushed > 0 && pushed <= 4 && !q.empty());
+        assert(q.consume(sum) && q.push([](long&) {}));
+
+        // 剩余的记录在队列析构时析构
+        tracked t;
+        assert(q.consume(sum) && q.push([t](long&) {}));
+        assert(tracked::live.load() == 2);
+    }
+    assert(tracked::live.load() == 0);
+
+    // 作为线程池的任务队列, append / append_to 均以闭包直接入队
+    basic_pool<inline_queue<1 << 16>, cv_wait, future_task> pool(thread_number);
+    pool.init();
+    std::vector<std::future<int>> results;
+    for (int i = 0; i < 1000; ++i) {
+        results.emplace_back(i % 2 ? pool.append([](int x) { return x; }, i) : pool.append_to(i, [](int x) { return x; }, i));
+    }
+    for (int i = 0; i < 1000; ++i) {
+        assert(results[i].get() == i);
+    }
+    pool.shutdown();
+}
+
+void testPipeline()
+{
+    constexpr int n = 10000;
+    constexpr size_t tokens = 8;
+    basic_pool<circular_queue<64>, cv_wait, detached_task> pool(thread_number);
+    pool.init();
+
+    struct item { int id; long square; };
+    int next = 0;
+    std::atomic<int> in_flight{0}, max_in_flight{0};
+    long sum = 0;
+    std::vector<int> order;
+    pipeline<item, tokens> p([&](item& x) {
+        if (next == n)
+            return false;
+        x.id = next++;
+        int cur = in_flight.fetch_add(1) + 1;
+        max_in_flight.store(std::max(max_in_flight.load(), cur));
+        return true;
+    });
+    p.add_stage(stage_mode::parallel, [](item& x) { x.square = static_cast<long>(x.id) * x.id; })
+     .add_stage(stage_mode::serial_out_of_order, [&](item& x) { sum += x.square; })
+     .add_stage(stage_mode::serial_in_order, [&](item& x) {
+         order.push_back(x.id);
+         in_flight.fetch_sub(1);
+     });
+    p.run(pool);
+
+    // 串行阶段不并发执行, serial_in_order 按输入顺序, 同时在流水线中的元素不超过 tokens
+    assert(static_cast<int>(order.size()) == n);
+    for (int i = 0; i < n; ++i) {
+        assert(order[i] == i);
+    }
+    assert(sum == static_cast<long>(n - 1) * n * (2 * n - 1) / 6);
+    assert(max_in_flight.load() <= static_cast<int>(tokens));
+
+    // 阶段抛出异常后停止读取输入, run 重新抛出异常; 之后可再次 run
+    next = 0;
+    order.clear();
+    p.add_stage(stage_mode::parallel, [](item& x) {
+        if (x.id == 100)
+            throw std::runtime_error("stage failed");
+    });
+    bool thrown = false;
+    try {
+        p.run(pool);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown && next < n);
+    pool.shutdown();
+
+    // 少量 token 多次 run, 覆盖串行阶段与读取输入在释放执行权时的交错
+    basic_pool<circular_queue<64>, cv_wait, detached_task> stress_pool(thread_number);
+    stress_pool.init();
+    int count = 0;
+    std::vector<int> seen;
+    pipeline<item, 2> q([&](item& x) {
+        if (count == 200)
+            return false;
+        x.id = count++;
+        return true;
+    });
+    q.add_stage(stage_mode::serial_out_of_order, [](item& x) { x.square = x.id; })
+     .add_stage(stage_mode::parallel, [](item& x) { x.square *= x.id; })
+     .add_stage(stage_mode::serial_in_order, [&](item& x) { seen.push_back(x.id); });
+    for (int round = 0; round < 200; ++round) {
+        count = 0;
+        seen.clear();
+        q.run(stress_pool);
+        assert(static_cast<int>(seen.size()) == 200);
+        for (int i = 0; i < 200; ++i) {
+            assert(seen[i] == i);
+        }
+    }
+    stress_pool.shutdown();
+}
+
+int main() {
+    testSemantics();
+    testBurst();
+    testContext();
+    testBlocking();
+    testHugePages();
+    testIo();
+    testPipeline();
+    testInlineQueue();
+
+    bench<list_queue, cv_wait>("list_queue + cv_wait    ");
+    bench<list_queue, yield_wait>("list_queue + yield_wait ");
+    bench<circular_queue<1024>, cv_wait>("circular_queue + cv_wait");
+    bench<circular_queue<1024>, yield_wait>("circular_queue + yield_wait");
+    bench<inline_queue<1 << 16>, cv_wait>("inline_queue + cv_wait  ");
+    bench<inline_queue<1 << 16>, yield_wait>("inline_queue + yield_wait");
+    if (std::thread::hardware_concurrency() > thread_number) {
+        bench<circular_queue<1024>, spin_wait>("circular_queue + spin_wait");
+    }
+    return 0;
+}
@@ -0,0 +1,94 @@
+/*
+    线程本地上下文 (ContextPolicy)
+    context 在线程启动时构造一次, 任务通过 append_with_context 直接获得执行线程的 context 引用,
+    无需 thread_local 查找或加锁, 可在其中复用缓冲区、解析器、压缩器等, 避免每个任务重新分配
+
+    - arena_context<Size, HugePages>: 每个线程一个 Size 字节的 arena, 每个任务执行后重置
+      HugePages 为 true 时 arena 使用预先缺页的 2MB 大页
+    - 自定义上下文: 提供 class context { void after_task(); } 即可
+*/
+#pragma once
+
+#include<new>
+#include<memory>
+#include<cstddef>
+#include<cstdint>
+#include<type_traits>
+
+#include"../LockFreePool/huge_page_allocator.hpp"
+
+// 单线程使用的 bump allocator, reset 后整体复用; 不调用对象的析构函数
+class worker_arena
+{
+public:
+    explicit worker_arena(size_t capacity, bool huge_pages = false)
+        : buffer_(huge_pages ? huge_page_allocator<unsigned char>().allocate(capacity) : new unsigned char[capacity],
+                  buffer_deleter{capacity, huge_pages}),
+          capacity_(capacity), used_(0)
+    {
+    }
+
+#pragma region copy and move delete
+    worker_arena(const worker_arena &) = delete;
+    worker_arena &operator=(const worker_arena &) = delete;
+    worker_arena(worker_arena &&) = delete;
+    worker_arena &operator=(worker_arena &&) = delete;
+#pragma endregion
+
+    // 空间不足时抛出 std::bad_alloc
+    void *allocate(size_t size, size_t align = alignof(std::max_align_t))
+    {
+        size_t offset = (used_ + align - 1) & ~(align - 1);
+        if (offset > capacity_ || size > capacity_ - offset)
+            throw std::bad_alloc();
+        used_ = offset + size;
+        return buffer_.get() + offset;
+    }
+
+    template<typename T>
+    T *allocate_array(size_t n)
+    {
+        static_assert(std::is_trivially_destructible<T>::value, "worker_arena does not run destructors");
+        return static_cast<T *>(allocate(n * sizeof(T), alignof(T)));
+    }
+
+    template<typename T, typename... Args>
+    T *create(Args &&...args)
+    {
+        static_assert(std::is_trivially_destructible<T>::value, "worker_arena does not run destructors");
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    void reset() { used_ = 0; }
+    size_t used() const { return used_; }
+    size_t capacity() const { return capacity_; }
+
+private:
+    struct buffer_deleter
+    {
+        size_t capacity;
+        bool huge_pages;
+        void operator()(unsigned char *p) const
+        {
+            if (huge_pages)
+                huge_page_allocator<unsigned char>().deallocate(p, capacity);
+            else
+                delete[] p;
+        }
+    };
+
+    std::unique_ptr<unsigned char[], buffer_deleter> buffer_;
+    size_t capacity_;
+    size_t used_;
+};
+
+template<size_t Size = 1024 * 1024, bool HugePages = false>
+struct arena_context
+{
+    class context : public worker_arena
+    {
+    public:
+        context() : worker_arena(Size, HugePages) {}
+        void after_task() { reset(); }
+    };
+};
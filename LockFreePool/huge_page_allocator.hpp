@@ -0,0 +1,101 @@
+/*
+    huge_page_allocator: 以 2MB 大页分配并预先缺页的内存, 可用作 CircularQueue 的 alloc 参数
+        CircularQueue<T, Cap, huge_page_allocator<T>> q;
+
+    - 优先使用显式大页 (MAP_HUGETLB, 需要预留 /proc/sys/vm/nr_hugepages)
+    - 失败时退化为按 2MB 对齐的普通映射 + madvise(MADV_HUGEPAGE) 透明大页
+    - 返回前完成缺页, 首次访问不再产生 page fault
+    每次分配至少占用一个大页, 适用于容量较大的队列
+*/
+#pragma once
+
+#include<sys/mman.h>
+#include<new>
+#include<memory>
+#include<cstddef>
+#include<cstdint>
+
+#ifndef MADV_POPULATE_WRITE
+#define MADV_POPULATE_WRITE 23      // linux 5.14
+#endif
+
+template<typename T>
+class huge_page_allocator
+{
+public:
+    using value_type = T;
+    static constexpr size_t huge_page_size = 2 * 1024 * 1024;
+    static constexpr size_t page_size = 4096;
+
+    huge_page_allocator() noexcept = default;
+    template<typename U>
+    huge_page_allocator(const huge_page_allocator<U> &) noexcept {}
+
+    T *allocate(size_t n)
+    {
+        size_t bytes = round_up(n * sizeof(T));
+        void *p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE, -1, 0);
+        if (p == MAP_FAILED)
+        {
+            p = map_transparent(bytes);
+        }
+        return static_cast<T *>(p);
+    }
+
+    void deallocate(T *p, size_t n) noexcept
+    {
+        munmap(p, round_up(n * sizeof(T)));
+    }
+
+    // CircularQueue 直接调用 alloc::construct / alloc::destroy
+    template<typename U, typename... Args>
+    void construct(U *p, Args &&...args)
+    {
+        ::new (static_cast<void *>(p)) U(std::forward<Args>(args)...);
+    }
+
+    template<typename U>
+    void destroy(U *p)
+    {
+        p->~U();
+    }
+
+private:
+    static size_t round_up(size_t bytes)
+    {
+        return (bytes + huge_page_size - 1) & ~(huge_page_size - 1);
+    }
+
+    // 多映射一个大页以便按 2MB 对齐, 再释放首尾多余部分
+    static void *map_transparent(size_t bytes)
+    {
+        size_t mapped = bytes + huge_page_size;
+        void *raw = mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED)
+            throw std::bad_alloc();
+        uintptr_t begin = reinterpret_cast<uintptr_t>(raw);
+        uintptr_t aligned = (begin + huge_page_size - 1) & ~(huge_page_size - 1);
+        if (aligned > begin)
+            munmap(raw, aligned - begin);
+        if (begin + mapped > aligned + bytes)
+            munmap(reinterpret_cast<void *>(aligned + bytes), begin + mapped - aligned - bytes);
+
+        char *p = reinterpret_cast<char *>(aligned);
+        madvise(p, bytes, MADV_HUGEPAGE);
+        if (madvise(p, bytes, MADV_POPULATE_WRITE) != 0)
+        {
+            for (size_t i = 0; i < bytes; i += page_size)
+            {
+                static_cast<volatile char *>(p)[i] = 0;
+            }
+        }
+        return p;
+    }
+};
+
+template<typename T, typename U>
+bool operator==(const huge_page_allocator<T> &, const huge_page_allocator<U> &) { return true; }
+
+template<typename T, typename U>
+bool operator!=(const huge_page_allocator<T> &, const huge_page_allocator<U> &) { return false; }
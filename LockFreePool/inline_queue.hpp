@@ -0,0 +1,236 @@
+/*
+    InlineQueue: 变长任务记录的有界无锁队列 (多生产者, 多消费者)
+    每个可调用对象连同其捕获的状态直接写入连续的环形字节缓冲区, 记录头部保存 invoke / destroy 函数指针,
+    消费者在缓冲区中原地调用后析构, 没有 std::function 的间接调用与堆分配, 小闭包只占用一个 cell
+
+        InlineQueue<void(int), 1 << 16> q;
+        q.push([p](int x) { p->run(x); });     // 队列满时返回 false
+        q.consume(42);                          // 取出一条记录并以 (42) 调用, 队列空时返回 false
+
+    - 缓冲区按 64 字节划分为 cell, 每条记录占用连续的若干 cell; 环尾剩余的 cell 不足时先写入一条填充记录
+    - 每个 cell 有独立的序号 (参考 Vyukov bounded MPMC queue), 记录执行并析构后才释放其 cell,
+      多个消费者可以乱序完成; 生产者遇到尚未释放的 cell 时视为队列满
+    - Bytes 须为 64 的 2 的幂倍, 单个闭包不能超过 Bytes
+*/
+#pragma once
+
+#include<new>
+#include<atomic>
+#include<memory>
+#include<cstddef>
+#include<cstdint>
+#include<utility>
+#include<type_traits>
+
+template<typename Signature, size_t Bytes>
+class InlineQueue;
+
+template<size_t Bytes, typename... Args>
+class InlineQueue<void(Args...), Bytes>
+{
+private:
+    static constexpr size_t CELL_SIZE = 64;
+    static constexpr size_t cells_ = Bytes / CELL_SIZE;
+    static constexpr size_t mask_ = cells_ - 1;
+    static_assert(Bytes % CELL_SIZE == 0 && cells_ >= 2 && (cells_ & mask_) == 0,
+                  "InlineQueue requires a power-of-two number of 64-byte cells");
+
+    struct alignas(CELL_SIZE) cell
+    {
+        unsigned char bytes[CELL_SIZE];
+    };
+
+    // 每个 cell 的状态, 与缓冲区分开存放, 使记录在缓冲区中连续
+    struct cell_state
+    {
+        std::atomic<size_t> seq;        // == pos: 空闲; == pos + 1: 位置 pos 处的记录已写入
+        std::atomic<size_t> cells;      // 以该 cell 开始的记录占用的 cell 数
+    };
+
+    // 记录头部, 之后紧跟闭包; invoke 为空表示填充记录
+    struct header
+    {
+        void (*invoke)(unsigned char *, Args...);
+        void (*destroy)(unsigned char *);
+    };
+
+    template<typename F>
+    static constexpr size_t offset_of()
+    {
+        return (sizeof(header) + alignof(F) - 1) & ~(alignof(F) - 1);
+    }
+
+    template<typename F>
+    static constexpr size_t cells_of()
+    {
+        return (offset_of<F>() + sizeof(F) + CELL_SIZE - 1) / CELL_SIZE;
+    }
+
+    template<typename F>
+    static F *payload(unsigned char *record)
+    {
+        return std::launder(reinterpret_cast<F *>(record + offset_of<F>()));
+    }
+
+    template<typename F>
+    static void invoke(unsigned char *record, Args... args)
+    {
+        (*payload<F>(record))(std::forward<Args>(args)...);
+    }
+
+    template<typename F>
+    static void destroy(unsigned char *record)
+    {
+        payload<F>(record)->~F();
+    }
+
+public:
+    InlineQueue() : head_{0}, tail_{0}, state_(new cell_state[cells_]), buffer_(new cell[cells_])
+    {
+        for (size_t i = 0; i < cells_; ++i)
+        {
+            state_[i].seq.store(i, std::memory_order_relaxed);
+            state_[i].cells.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    ~InlineQueue()
+    {
+        for (size_t pos = head_.load(); pos != tail_.load(); pos += state_[pos & mask_].cells.load())
+        {
+            header *h = record_header(pos & mask_);
+            if (h->invoke != nullptr)
+                h->destroy(record(pos & mask_));
+        }
+    }
+
+#pragma region copy and move delete
+    InlineQueue(const InlineQueue &) = delete;
+    InlineQueue &operator=(const InlineQueue &) = delete;
+    InlineQueue(InlineQueue &&) = delete;
+    InlineQueue &operator=(InlineQueue &&) = delete;
+#pragma endregion
+
+    bool empty() const
+    {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+    // 将闭包写入缓冲区, 队列满时返回 false 且不移动 func
+    template<typename F>
+    bool push(F &&func)
+    {
+        using callable = std::decay_t<F>;
+        static_assert(alignof(callable) <= CELL_SIZE, "InlineQueue: over-aligned task");
+        constexpr size_t need = cells_of<callable>();
+        static_assert(need <= cells_, "InlineQueue: task is larger than the queue");
+
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        while (true)
+        {
+            size_t index = pos & mask_;
+            size_t n = index + need > cells_ ? cells_ - index : need;
+            intptr_t diff = check_free(pos, n);
+            if (diff < 0)
+                return false;                   // 上一轮的记录尚未执行完毕
+            if (diff > 0)
+            {
+                pos = tail_.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (!tail_.compare_exchange_weak(pos, pos + n, std::memory_order_relaxed))
+                continue;
+
+            header *h = new (record(index)) header;
+            state_[index].cells.store(n, std::memory_order_relaxed);
+            if (n != need)
+            {
+                // 环尾空间不足, 写入填充记录后从缓冲区开头重试
+                h->invoke = nullptr;
+                h->destroy = nullptr;
+                state_[index].seq.store(pos + 1, std::memory_order_release);
+                pos = tail_.load(std::memory_order_relaxed);
+                continue;
+            }
+            new (record(index) + offset_of<callable>()) callable(std::forward<F>(func));
+            h->invoke = &invoke<callable>;
+            h->destroy = &destroy<callable>;
+            state_[index].seq.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+    }
+
+    // 取出一条记录, 在缓冲区中原地以 (args...) 调用并析构
+    bool consume(Args... args)
+    {
+        size_t pos = head_.load(std::memory_order_relaxed);
+        while (true)
+        {
+            size_t index = pos & mask_;
+            intptr_t diff = static_cast<intptr_t>(state_[index].seq.load(std::memory_order_acquire) - (pos + 1));
+            if (diff < 0)
+                return false;                   // 队列空, 或记录尚未写入完成
+            if (diff > 0)
+            {
+                pos = head_.load(std::memory_order_relaxed);
+                continue;
+            }
+            size_t n = state_[index].cells.load(std::memory_order_relaxed);
+            if (!head_.compare_exchange_weak(pos, pos + n, std::memory_order_relaxed))
+                continue;
+
+            header *h = record_header(index);
+            if (h->invoke == nullptr)
+            {
+                release(pos, n);
+                pos = head_.load(std::memory_order_relaxed);
+                continue;
+            }
+            // 任务抛出异常时同样析构并释放 cell
+            struct finish
+            {
+                InlineQueue *queue;
+                header *h;
+                size_t pos, n;
+                ~finish()
+                {
+                    h->destroy(queue->record(pos & mask_));
+                    queue->release(pos, n);
+                }
+            } guard{this, h, pos, n};
+            h->invoke(record(index), std::forward<Args>(args)...);
+            return true;
+        }
+    }
+
+private:
+    unsigned char *record(size_t index) const { return buffer_[index].bytes; }
+    header *record_header(size_t index) const { return std::launder(reinterpret_cast<header *>(record(index))); }
+
+    // 0: [pos, pos + n) 均空闲; < 0: 队列满; > 0: pos 已过期
+    intptr_t check_free(size_t pos, size_t n) const
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            size_t seq = state_[(pos + i) & mask_].seq.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq - (pos + i));
+            if (diff != 0)
+                return diff;
+        }
+        return 0;
+    }
+
+    void release(size_t pos, size_t n)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            state_[(pos + i) & mask_].seq.store(pos + i + cells_, std::memory_order_release);
+        }
+    }
+
+private:
+    alignas(CELL_SIZE) std::atomic<size_t> head_;
+    alignas(CELL_SIZE) std::atomic<size_t> tail_;
+    std::unique_ptr<cell_state[]> state_;
+    std::unique_ptr<cell[]> buffer_;
+};
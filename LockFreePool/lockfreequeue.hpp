@@ -1,3 +1,4 @@
+#pragma once
 /*
     2024.3.12   by yxr
     Circular Lock-free Queue
@@ -13,6 +14,8 @@
 #include<future>
 #include<iostream>
 #include<chrono>
+#include<thread>
+#include<type_traits>
 
 template<typename T,  size_t Cap, class alloc = std::allocator<T>>
 class CircularQueue: private alloc{
@@ -73,11 +76,16 @@ public:
         // 3. update tail_update_
 
         // 更新tail_update_: 保证tail_update_ == tail_( tail_ != head_ => tail_update_ != head_ )时，数据已经更新完
+        // 前一个位置的写入者被抢占时让出时间片, 否则线程数多于核数时会一直空转到其重新被调度
         size_t tailup;
-        do{
+        while(true){
             tailup = tail;
-        }while(tail_update_.compare_exchange_strong(tailup,(tailup + 1) % max_size_,                    // 4 release store
-                std::memory_order_release, std::memory_order_relaxed) == false);
+            if(tail_update_.compare_exchange_strong(tailup,(tailup + 1) % max_size_,                    // 4 release store
+                std::memory_order_release, std::memory_order_relaxed)){
+                break;
+            }
+            std::this_thread::yield();
+        }
     
         return true;
     }
@@ -90,6 +98,12 @@ public:
         return this->emplace(std::move(value));
     }
 
+    // 可转换为 T 的对象在 emplace 中原地构造, 队列满时 value 不被移动
+    template<typename U, typename = std::enable_if_t<!std::is_same<std::decay_t<U>, T>::value>>
+    bool push(U&& value){
+        return this->emplace(std::forward<U>(value));
+    }
+
     bool pop(T& value){
         T value_temp;
         size_t head;
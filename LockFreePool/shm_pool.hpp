@@ -0,0 +1,144 @@
+/*
+    ShmPool: 从共享内存队列 ShmQueue 中消费任务描述的线程池前端
+    创建 ShmQueue, 由一个分发线程从中取出任务描述并以 pool().append 提交, 在 pool 的线程上调用 handler(const T&)
+    其他进程以 ShmQueue<T, Cap>::open_only 打开同名队列后 push 即可, 进程之间不经过 socket / pipe
+
+    - pool 为 basic_pool<inline_queue<...>, cv_wait, detached_task>:
+      分发线程在 ShmQueue 的 futex 上等待, pool 的空闲线程在条件变量上休眠, 没有任务时不占用 CPU
+    - 任务描述的路径: 共享内存 -> 分发线程的局部变量 (ShmQueue::pop) -> 闭包 -> pool 任务队列中的记录 (InlineQueue::push),
+      均为 trivially copyable 的按字节拷贝, 闭包原地存放在 InlineQueue 的缓冲区中并原地执行, 每个任务没有堆分配与 future
+
+    - 析构时删除共享内存段
+    - 分发线程不占用 pool 的线程, handler 或其他调用者可以继续通过 pool().append / append_to / append_blocking 提交任务
+    - pool 的任务队列满时分发线程等待, 共享内存队列随之变满, 生产者在 push_wait 中等待
+    - handler 抛出的第一个异常在 shutdown 时重新抛出, 之后的任务描述照常处理
+*/
+#pragma once
+
+#include<mutex>
+#include<string>
+#include<atomic>
+#include<chrono>
+#include<thread>
+#include<utility>
+#include<exception>
+#include<functional>
+
+#include"shm_queue.hpp"
+#include"../BasicPool/basic_pool.hpp"
+
+template<typename T, size_t Cap>
+class ShmPool
+{
+public:
+    using handler_type = std::function<void(const T &)>;
+    using pool_type = basic_pool<inline_queue<64 * 1024>, cv_wait, detached_task>;
+
+    ShmPool(const std::string &name, handler_type handler, int thread_number = 8);
+    ~ShmPool();
+
+    void init();       // 启动分发线程与 pool
+    void shutdown();   // 停止分发并等待已提交的任务执行完毕, 共享内存队列中剩余的任务描述保留
+
+    pool_type &pool() { return pool_; }
+
+#pragma region delete copy and move
+    ShmPool(const ShmPool &) = delete;
+    ShmPool(const ShmPool &&) = delete;
+    ShmPool &operator=(const ShmPool &) = delete;
+    ShmPool &operator=(const ShmPool &&) = delete;
+#pragma endregion
+
+private:
+    static constexpr std::chrono::milliseconds wait_timeout{100};
+
+    void dispatchFunc();            // 分发线程: 从共享内存队列取出任务描述提交到 pool
+    void handle(const T &value);    // 在 pool 的线程上调用 handler, 记录第一个异常
+private:
+    std::string name_;
+    ShmQueue<T, Cap> queue_;
+    handler_type handler_;
+    std::atomic<bool> stop_;
+    pool_type pool_;
+    std::thread dispatcher_;
+    std::mutex mutex_;
+    std::exception_ptr error_;
+};
+
+template<typename T, size_t Cap>
+ShmPool<T, Cap>::ShmPool(const std::string &name, handler_type handler, int thread_number)
+    : name_(name), queue_(name, ShmQueue<T, Cap>::create_only), handler_(std::move(handler)),
+      stop_(false), pool_(thread_number)
+{
+}
+
+template<typename T, size_t Cap>
+ShmPool<T, Cap>::~ShmPool()
+{
+    try
+    {
+        shutdown();
+    }
+    catch (...)
+    {
+    }
+    ShmQueue<T, Cap>::unlink(name_);
+}
+
+template<typename T, size_t Cap>
+void ShmPool<T, Cap>::init()
+{
+    if (dispatcher_.joinable()) return;
+    stop_.store(false, std::memory_order_release);
+    pool_.init(true);
+    dispatcher_ = std::thread(&ShmPool::dispatchFunc, this);
+}
+
+template<typename T, size_t Cap>
+void ShmPool<T, Cap>::shutdown()
+{
+    stop_.store(true, std::memory_order_release);
+    queue_.wake_consumers();
+    if (dispatcher_.joinable())
+    {
+        dispatcher_.join();
+    }
+    pool_.shutdown();
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        error = std::exchange(error_, nullptr);
+    }
+    if (error)
+    {
+        std::rethrow_exception(error);     // 重新抛出 handler 的异常
+    }
+}
+
+template<typename T, size_t Cap>
+void ShmPool<T, Cap>::dispatchFunc()
+{
+    T value;
+    while (!stop_.load(std::memory_order_acquire))
+    {
+        if (queue_.pop_wait(value, wait_timeout))
+        {
+            pool_.append(&ShmPool::handle, this, value);
+        }
+    }
+}
+
+template<typename T, size_t Cap>
+void ShmPool<T, Cap>::handle(const T &value)
+{
+    try
+    {
+        handler_(value);
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        if (!error_)
+            error_ = std::current_exception();
+    }
+}
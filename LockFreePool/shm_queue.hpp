@@ -0,0 +1,280 @@
+/*
+    ShmQueue: 位于命名共享内存中的循环无锁队列, 用于多个进程之间传递定长任务描述
+    算法与 CircularQueue 相同 (head_ / tail_ / tail_update_), 区别在于:
+    - 队列位于 shm_open 创建的共享内存段中, 环形缓冲区通过相对段首的偏移访问, 不保存任何指针
+    - T 必须是 trivially copyable, 元素以字节拷贝的方式写入与读出
+    - 队列空/满时通过 futex 等待, 只有存在等待者时 push / pop 才会调用 futex_wake, 快速路径没有系统调用
+
+    创建者: ShmQueue<Job, 1024> q("/jobs", ShmQueue<Job, 1024>::create_only);
+    其他进程: ShmQueue<Job, 1024> q("/jobs", ShmQueue<Job, 1024>::open_only);
+    段不会自动删除, 不再使用时调用 ShmQueue::unlink(name)
+    注意: 进程在 push 过程中崩溃会使其后的 push 一直等待 (与 CircularQueue 相同)
+*/
+#pragma once
+
+#include<linux/futex.h>
+#include<sys/syscall.h>
+#include<sys/mman.h>
+#include<sys/stat.h>
+#include<fcntl.h>
+#include<unistd.h>
+#include<ctime>
+#include<cerrno>
+#include<atomic>
+#include<chrono>
+#include<string>
+#include<thread>
+#include<cstdint>
+#include<cstring>
+#include<climits>
+#include<stdexcept>
+#include<system_error>
+#include<type_traits>
+
+template<typename T, size_t Cap>
+class ShmQueue
+{
+    static_assert(std::is_trivially_copyable<T>::value, "ShmQueue requires a trivially copyable T");
+    static_assert(std::atomic<size_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+                  "ShmQueue requires address-free atomics");
+private:
+    static constexpr size_t CACHELINE_SIZE = 64;
+    static constexpr uint64_t MAGIC = 0x53484d5155455545ULL;     // "SHMQUEUE"
+
+    // 共享内存段的头部, 之后紧跟环形缓冲区
+    struct header
+    {
+        uint64_t magic;
+        uint64_t max_size;
+        uint64_t element_size;
+        std::atomic<uint32_t> ready;                              // 创建者初始化完成后置 1
+        alignas(CACHELINE_SIZE) std::atomic<size_t> head_;
+        alignas(CACHELINE_SIZE) std::atomic<size_t> tail_;
+        alignas(CACHELINE_SIZE) std::atomic<size_t> tail_update_;
+        alignas(CACHELINE_SIZE) std::atomic<uint32_t> push_seq;   // futex: 每次 push 加 1, 消费者在其上等待
+        std::atomic<uint32_t> pop_waiters;
+        alignas(CACHELINE_SIZE) std::atomic<uint32_t> pop_seq;    // futex: 每次 pop 加 1, 生产者在其上等待
+        std::atomic<uint32_t> push_waiters;
+    };
+
+    static constexpr size_t data_offset = (sizeof(header) + CACHELINE_SIZE - 1) & ~(CACHELINE_SIZE - 1);
+    static constexpr size_t max_size_ = Cap + 1;
+    static constexpr size_t segment_size = data_offset + max_size_ * sizeof(T);
+
+public:
+    enum mode { create_only, open_only };
+
+    ShmQueue(const std::string &name, mode m)
+    {
+        int flags = m == create_only ? (O_CREAT | O_EXCL | O_RDWR) : O_RDWR;
+        int fd = shm_open(name.c_str(), flags, 0600);
+        if (fd < 0)
+            throw std::system_error(errno, std::generic_category(), "ShmQueue: shm_open " + name);
+        if (m == create_only && ftruncate(fd, segment_size) != 0)
+        {
+            int err = errno;
+            close(fd);
+            shm_unlink(name.c_str());
+            throw std::system_error(err, std::generic_category(), "ShmQueue: ftruncate " + name);
+        }
+        // 创建者在 shm_open 与 ftruncate 之间时段大小为 0, 之后初始化完成前 ready 为 0, 两者共用同一个等待期限
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+        struct stat st;
+        while (true)
+        {
+            if (fstat(fd, &st) != 0)
+            {
+                int err = errno;
+                close(fd);
+                throw std::system_error(err, std::generic_category(), "ShmQueue: fstat " + name);
+            }
+            if (static_cast<size_t>(st.st_size) == segment_size)
+                break;
+            if (st.st_size != 0 || std::chrono::steady_clock::now() > deadline)
+            {
+                close(fd);
+                throw std::runtime_error("ShmQueue: segment size mismatch for " + name);
+            }
+            std::this_thread::yield();
+        }
+        void *base = mmap(nullptr, segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (base == MAP_FAILED)
+            throw std::system_error(errno, std::generic_category(), "ShmQueue: mmap " + name);
+        base_ = static_cast<char *>(base);
+
+        if (m == create_only)
+        {
+            header *h = new (base_) header();
+            h->magic = MAGIC;
+            h->max_size = max_size_;
+            h->element_size = sizeof(T);
+            h->ready.store(1, std::memory_order_release);
+        }
+        else
+        {
+            // 等待创建者完成初始化
+            while (hdr()->ready.load(std::memory_order_acquire) == 0)
+            {
+                if (std::chrono::steady_clock::now() > deadline)
+                {
+                    munmap(base_, segment_size);
+                    throw std::runtime_error("ShmQueue: segment not initialized " + name);
+                }
+                std::this_thread::yield();
+            }
+            if (hdr()->magic != MAGIC || hdr()->max_size != max_size_ || hdr()->element_size != sizeof(T))
+            {
+                munmap(base_, segment_size);
+                throw std::runtime_error("ShmQueue: segment layout mismatch for " + name);
+            }
+        }
+    }
+
+    ~ShmQueue()
+    {
+        munmap(base_, segment_size);
+    }
+
+    static void unlink(const std::string &name)
+    {
+        shm_unlink(name.c_str());
+    }
+
+#pragma region copy and move delete
+    ShmQueue(const ShmQueue &) = delete;
+    ShmQueue &operator=(const ShmQueue &) = delete;
+    ShmQueue(ShmQueue &&) = delete;
+    ShmQueue &operator=(ShmQueue &&) = delete;
+#pragma endregion
+
+    bool empty() const
+    {
+        return hdr()->head_.load(std::memory_order_acquire) == hdr()->tail_.load(std::memory_order_acquire);
+    }
+
+    bool push(const T &value)
+    {
+        header *h = hdr();
+        size_t tail;
+        do
+        {
+            tail = h->tail_.load(std::memory_order_relaxed);
+            if ((tail + 1) % max_size_ == h->head_.load(std::memory_order_acquire))
+                return false;
+        } while (h->tail_.compare_exchange_weak(tail, (tail + 1) % max_size_, std::memory_order_release,
+                                                std::memory_order_relaxed) == false);
+
+        std::memcpy(static_cast<void *>(data() + tail), &value, sizeof(T));
+
+        // 前一个位置的写入者被抢占时让出时间片, 与 CircularQueue::emplace 相同; 多个生产者进程时线程数通常多于核数
+        size_t tailup;
+        while (true)
+        {
+            tailup = tail;
+            if (h->tail_update_.compare_exchange_strong(tailup, (tailup + 1) % max_size_,
+                                                        std::memory_order_release, std::memory_order_relaxed))
+                break;
+            std::this_thread::yield();
+        }
+
+        notify(h->push_seq, h->pop_waiters, 1);
+        return true;
+    }
+
+    bool pop(T &value)
+    {
+        header *h = hdr();
+        T value_temp;
+        size_t head;
+        do
+        {
+            head = h->head_.load(std::memory_order_relaxed);
+            if (head == h->tail_.load(std::memory_order_acquire))
+                return false;
+            if (head == h->tail_update_.load(std::memory_order_acquire))
+                return false;
+            std::memcpy(static_cast<void *>(&value_temp), data() + head, sizeof(T));
+        } while (h->head_.compare_exchange_weak(head, (head + 1) % max_size_,
+                                                std::memory_order_release, std::memory_order_relaxed) == false);
+        value = value_temp;
+
+        notify(h->pop_seq, h->push_waiters, 1);
+        return true;
+    }
+
+    // 队列满时在 futex 上等待, 超时返回 false
+    bool push_wait(const T &value, std::chrono::milliseconds timeout)
+    {
+        header *h = hdr();
+        return wait_until([&]() { return push(value); }, h->pop_seq, h->push_waiters, timeout, false);
+    }
+
+    // 队列空时在 futex 上等待, 超时或被唤醒后仍未取到数据时返回 false (如 wake_consumers)
+    bool pop_wait(T &value, std::chrono::milliseconds timeout)
+    {
+        header *h = hdr();
+        return wait_until([&]() { return pop(value); }, h->push_seq, h->pop_waiters, timeout, true);
+    }
+
+    // 唤醒所有在 pop_wait 中等待的消费者, 用于关闭
+    void wake_consumers()
+    {
+        header *h = hdr();
+        h->push_seq.fetch_add(1);
+        futex(&h->push_seq, FUTEX_WAKE, INT_MAX, nullptr);
+    }
+
+private:
+    header *hdr() const { return reinterpret_cast<header *>(base_); }
+    T *data() const { return reinterpret_cast<T *>(base_ + data_offset); }
+
+    static long futex(std::atomic<uint32_t> *addr, int op, uint32_t val, const timespec *ts)
+    {
+        // 跨进程使用, 不能带 FUTEX_PRIVATE_FLAG
+        return syscall(SYS_futex, reinterpret_cast<uint32_t *>(addr), op, val, ts, nullptr, 0);
+    }
+
+    // 与 wait_until 配对: 先更新 seq, 有等待者时才进入内核
+    static void notify(std::atomic<uint32_t> &seq, std::atomic<uint32_t> &waiters, int count)
+    {
+        seq.fetch_add(1);
+        if (waiters.load() != 0)
+            futex(&seq, FUTEX_WAKE, count, nullptr);
+    }
+
+    template<typename Op>
+    static bool wait_until(Op &&op, std::atomic<uint32_t> &seq, std::atomic<uint32_t> &waiters,
+                           std::chrono::milliseconds timeout, bool return_on_wake)
+    {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (true)
+        {
+            uint32_t seen = seq.load();
+            if (op())
+                return true;
+            auto now = std::chrono::steady_clock::now();
+            if (now >= deadline)
+                return false;
+            auto left = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - now).count();
+            timespec ts;
+            ts.tv_sec = left / 1000000000L;
+            ts.tv_nsec = left % 1000000000L;
+
+            waiters.fetch_add(1);
+            // seq 在 seen 之后被修改时 futex 立即返回, 不会丢失唤醒
+            long ret = futex(&seq, FUTEX_WAIT, seen, &ts);
+            waiters.fetch_sub(1);
+            if (ret == 0)
+            {
+                if (op())
+                    return true;
+                if (return_on_wake)
+                    return false;
+            }
+        }
+    }
+
+private:
+    char *base_;
+};
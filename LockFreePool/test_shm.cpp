@@ -0,0 +1,100 @@
+#include<iostream>
+#include<atomic>
+#include<cassert>
+#include<sys/wait.h>
+#include<unistd.h>
+#include"shm_pool.hpp"
+
+// 定长任务描述, 在共享内存中按字节拷贝
+struct job
+{
+    int producer;
+    int seq;
+    long value;
+};
+
+constexpr int producer_number = 4;  // 生产者进程数量
+constexpr int job_number = 20000;   // 每个生产者提交的任务数量
+constexpr size_t queue_size = 256;
+
+int main(){
+    const std::string name = "/threadpool_test_shm";
+    ShmQueue<job, queue_size>::unlink(name);
+
+    std::atomic<long> count{0}, sum{0};
+    ShmPool<job, queue_size> pool(name, [&](const job &j) {
+        count.fetch_add(1, std::memory_order_relaxed);
+        sum.fetch_add(j.value, std::memory_order_relaxed);
+    }, 2);
+    pool.init();
+
+    // 分发线程不占用 pool 的线程, 仍可提交其他任务
+    std::promise<int> answer;
+    pool.pool().append([&answer](int x) { answer.set_value(x + 1); }, 41);
+    assert(answer.get_future().get() == 42);
+
+    // 生产者进程以 open_only 打开同一个队列
+    for (int p = 0; p < producer_number; ++p) {
+        if (fork() == 0) {
+            ShmQueue<job, queue_size> q(name, ShmQueue<job, queue_size>::open_only);
+            for (int i = 0; i < job_number; ++i) {
+                job j{p, i, static_cast<long>(p) * job_number + i};
+                while (!q.push_wait(j, std::chrono::milliseconds(100))) {
+                }
+            }
+            _exit(0);
+        }
+    }
+    for (int p = 0; p < producer_number; ++p) {
+        int status;
+        wait(&status);
+        assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    }
+
+    long total = static_cast<long>(producer_number) * job_number;
+    while (count.load() < total) {
+        std::this_thread::yield();
+    }
+    pool.shutdown();
+    assert(count.load() == total);
+    assert(sum.load() == total * (total - 1) / 2);
+
+    // 布局不同的打开方式被拒绝
+    bool thrown = false;
+    try {
+        ShmQueue<job, queue_size * 2> q(name, ShmQueue<job, queue_size * 2>::open_only);
+    } catch (const std::runtime_error &) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // handler 的异常在 shutdown 时重新抛出, 之后的任务描述照常处理
+    const std::string fail_name = "/threadpool_test_shm_fail";
+    ShmQueue<job, queue_size>::unlink(fail_name);
+    std::atomic<int> handled{0};
+    ShmPool<job, queue_size> failing(fail_name, [&](const job &j) {
+        handled.fetch_add(1);
+        if (j.seq == 0)
+            throw std::runtime_error("handler failed");
+    }, 2);
+    failing.init();
+    {
+        ShmQueue<job, queue_size> q(fail_name, ShmQueue<job, queue_size>::open_only);
+        for (int i = 0; i < 10; ++i) {
+            assert(q.push_wait(job{0, i, 0}, std::chrono::milliseconds(100)));
+        }
+    }
+    while (handled.load() < 10) {
+        std::this_thread::yield();
+    }
+    thrown = false;
+    try {
+        failing.shutdown();
+    } catch (const std::runtime_error &) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    std::cout << "shm jobs: " << count.load() << std::endl;
+    return 0;
+}